@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ActiveSetQP.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+const int numVariables = 30;
+const int numEqualities = 6;
+const double eps = std::numeric_limits<double>::epsilon();
+const double inf = std::numeric_limits<double>::infinity();
+}
+
+//====================================================================
+ActiveSetQP::ActiveSetQP()
+  : mMaxIterations(200), mIterations(0), mRNorm(1.0) {
+  mActive.reserve(numVariables);
+  mU.resize(numVariables + 1);
+}
+
+//====================================================================
+bool ActiveSetQP::solve(const Eigen::MatrixXd& _P, const Eigen::VectorXd& _b,
+                        const Eigen::Matrix<double, 6, 30>& _A, const Eigen::Matrix<double, 6, 1>& _c,
+                        const Eigen::MatrixXd& _C, const Eigen::VectorXd& _d,
+                        const Eigen::Matrix<double, 30, 1>& _x0, double _damping,
+                        Eigen::Matrix<double, 30, 1>* _x) {
+  const int n = numVariables, numInequalities = (int)_C.rows();
+  mIterations = 0;
+
+  // min 1/2 x^T G x - g^T x, and J = L^-T for G = L L^T
+  mG.noalias() = _P.transpose()*_P;
+  mG.diagonal().array() += _damping;
+  mg.noalias() = _P.transpose()*_b;
+  mg += _damping*_x0;
+  mLLT.compute(mG);
+  if (mLLT.info() != Eigen::Success) return false;
+  mJ.setIdentity(n, n);
+  mLLT.matrixU().solveInPlace(mJ);
+  Eigen::Matrix<double, 30, 1> x = mLLT.solve(mg);
+
+  mR.setZero(n, n);
+  mU.setZero();
+  mActive.clear();
+  mRNorm = 1.0;
+
+  // The equalities go in first and stay
+  for (int i = 0; i < numEqualities; ++i) {
+    mNormal = _A.row(i).transpose();
+    computeStep(mNormal);
+    const int q = (int)mActive.size();
+    const double zn = mZ.dot(mNormal);
+    const double t = (mZ.squaredNorm() > eps) ? (_c(i) - mNormal.dot(x))/zn : 0.0;
+    x += t*mZ;
+    mU.head(q) -= t*mRU;
+    mU(q) = t;
+    if (!addConstraint(i)) return false;
+  }
+
+  mRowNorms = _C.rowwise().norm();
+  mBlocked.assign(numInequalities, 0);
+  for (std::size_t k = numEqualities; k < mActive.size(); ++k) mBlocked[mActive[k] - numEqualities] = 1;
+  std::size_t warm = 0;
+  while (true) {
+    // Pick a violated inequality, from the previous active set first, then
+    // the most violated one relative to its normal
+    mS.noalias() = _C*x - _d;
+    int p = -1;
+    while (p < 0 && warm < mWarmStart.size()) {
+      const int k = mWarmStart[warm++];
+      if (k < numInequalities && !mBlocked[k] && mS(k) < -1e-9*mRowNorms(k)) p = k;
+    }
+    if (p < 0) {
+      double worst = -1e-9;
+      for (int k = 0; k < numInequalities; ++k) {
+        if (mBlocked[k] || mRowNorms(k) == 0.0) continue;
+        const double violation = mS(k)/mRowNorms(k);
+        if (violation < worst) { worst = violation; p = k; }
+      }
+    }
+    if (p < 0) break;
+
+    // Step toward satisfying p, dropping active inequalities whose
+    // multipliers reach zero on the way
+    mNormal = _C.row(p).transpose();
+    int q = (int)mActive.size();
+    mU(q) = 0.0;
+    while (true) {
+      if (++mIterations > mMaxIterations) return false;
+      computeStep(mNormal);
+
+      double t1 = inf;
+      int drop = -1;
+      for (int k = numEqualities; k < q; ++k) {
+        if (mRU(k) > eps && mU(k)/mRU(k) < t1) {
+          t1 = mU(k)/mRU(k);
+          drop = k;
+        }
+      }
+      const double t2 = (mZ.squaredNorm() > eps)
+          ? -(mNormal.dot(x) - _d(p))/mZ.dot(mNormal) : inf;
+      const double t = std::min(t1, t2);
+      if (t == inf) return false;
+
+      if (t2 != inf) x += t*mZ;
+      mU.head(q) -= t*mRU;
+      mU(q) += t;
+      if (t2 <= t1) {
+        // A normal that depends on the active ones cannot be added, but the
+        // full step has satisfied it; either way p is done with
+        addConstraint(numEqualities + p);
+        mBlocked[p] = 1;
+        break;
+      }
+      mBlocked[mActive[drop] - numEqualities] = 0;
+      deleteConstraint(drop);
+      --q;
+    }
+  }
+
+  mWarmStart.clear();
+  for (std::size_t k = numEqualities; k < mActive.size(); ++k)
+    mWarmStart.push_back(mActive[k] - numEqualities);
+  if (!x.allFinite()) return false;
+  *_x = x;
+  return true;
+}
+
+//====================================================================
+void ActiveSetQP::computeStep(const Eigen::VectorXd& _normal) {
+  const int n = numVariables, q = (int)mActive.size();
+  // d = J^T n, z = J2 d2 the primal step, r = R^-1 d1 the change of the
+  // active multipliers
+  mD.noalias() = mJ.transpose()*_normal;
+  mZ.noalias() = mJ.rightCols(n - q)*mD.tail(n - q);
+  mRU = mR.topLeftCorner(q, q).triangularView<Eigen::Upper>().solve(mD.head(q));
+}
+
+//====================================================================
+bool ActiveSetQP::addConstraint(int _id) {
+  const int n = numVariables, q = (int)mActive.size();
+  // Givens rotations of J's columns q to n-1 that zero d below q, so the new
+  // column of R is d's head
+  for (int j = n - 1; j > q; --j) {
+    double cc = mD(j - 1), ss = mD(j);
+    const double h = std::hypot(cc, ss);
+    if (h == 0.0) continue;
+    mD(j) = 0.0;
+    cc /= h;
+    ss /= h;
+    if (cc < 0.0) {
+      cc = -cc;
+      ss = -ss;
+      mD(j - 1) = -h;
+    }
+    else mD(j - 1) = h;
+    const double xny = ss/(1.0 + cc);
+    for (int k = 0; k < n; ++k) {
+      const double t1 = mJ(k, j - 1), t2 = mJ(k, j);
+      mJ(k, j - 1) = t1*cc + t2*ss;
+      mJ(k, j) = xny*(t1 + mJ(k, j - 1)) - t2;
+    }
+  }
+  if (std::abs(mD(q)) <= eps*mRNorm) return false;
+  mR.col(q).head(q + 1) = mD.head(q + 1);
+  mRNorm = std::max(mRNorm, std::abs(mD(q)));
+  mActive.push_back(_id);
+  return true;
+}
+
+//====================================================================
+void ActiveSetQP::deleteConstraint(int _position) {
+  const int n = numVariables;
+  int q = (int)mActive.size();
+  for (int i = _position; i < q - 1; ++i) {
+    mActive[i] = mActive[i + 1];
+    mU(i) = mU(i + 1);
+    mR.col(i) = mR.col(i + 1);
+  }
+  mActive.pop_back();
+  mU(q - 1) = mU(q);
+  mU(q) = 0.0;
+  mR.col(q - 1).setZero();
+  --q;
+
+  // Givens rotations that make R upper triangular again, applied to J too
+  for (int j = _position; j < q; ++j) {
+    double cc = mR(j, j), ss = mR(j + 1, j);
+    const double h = std::hypot(cc, ss);
+    if (h == 0.0) continue;
+    cc /= h;
+    ss /= h;
+    mR(j + 1, j) = 0.0;
+    if (cc < 0.0) {
+      mR(j, j) = -h;
+      cc = -cc;
+      ss = -ss;
+    }
+    else mR(j, j) = h;
+    const double xny = ss/(1.0 + cc);
+    for (int k = j + 1; k < q; ++k) {
+      const double t1 = mR(j, k), t2 = mR(j + 1, k);
+      mR(j, k) = t1*cc + t2*ss;
+      mR(j + 1, k) = xny*(t1 + mR(j, k)) - t2;
+    }
+    for (int k = 0; k < n; ++k) {
+      const double t1 = mJ(k, j), t2 = mJ(k, j + 1);
+      mJ(k, j) = t1*cc + t2*ss;
+      mJ(k, j + 1) = xny*(mJ(k, j) + t1) - t2;
+    }
+  }
+}
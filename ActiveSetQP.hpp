@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EXAMPLES_OPERATIONALSPACECONTROL_ACTIVESETQP_HPP_
+#define EXAMPLES_OPERATIONALSPACECONTROL_ACTIVESETQP_HPP_
+
+#include <Eigen/Eigen>
+#include <vector>
+
+/// \brief Goldfarb-Idnani dual active-set solver for the controller QP with
+/// inequality constraints
+///   min 1/2 |_P x - _b|^2 + _damping/2 |x - _x0|^2
+///   s.t. _A x = _c,  _C x >= _d
+/// It starts from the unconstrained minimum and adds violated inequalities
+/// one at a time, dropping those whose multipliers would turn negative. The
+/// inequalities active at the previous solution are tried first, so when the
+/// active set barely changes between ticks a solve takes about one
+/// iteration per active constraint and never backtracks.
+class ActiveSetQP {
+public:
+  /// \brief Constructor
+  ActiveSetQP();
+
+  /// \brief Solve the QP, warm-started from the active set of the previous
+  /// solve. Returns false, leaving _x untouched, if the constraints are
+  /// infeasible or dependent, or the iteration limit is reached.
+  bool solve(const Eigen::MatrixXd& _P, const Eigen::VectorXd& _b,
+             const Eigen::Matrix<double, 6, 30>& _A, const Eigen::Matrix<double, 6, 1>& _c,
+             const Eigen::MatrixXd& _C, const Eigen::VectorXd& _d,
+             const Eigen::Matrix<double, 30, 1>& _x0, double _damping,
+             Eigen::Matrix<double, 30, 1>* _x);
+
+  /// \brief Rows of _C active at the last solution
+  const std::vector<int>& getActiveSet() const { return mWarmStart; }
+
+  /// \brief Try the rows _active of _C first in the next solve, as if they
+  /// had been active at the last solution. Used to restore a saved solver.
+  void setActiveSet(const std::vector<int>& _active) { mWarmStart = _active; }
+
+  /// \brief Forget the active set, so the next solve starts cold
+  void reset() { mWarmStart.clear(); }
+
+  /// \brief Iterations of the last solve
+  int getNumIterations() const { return mIterations; }
+
+  /// \brief Limit the iterations of a solve, 200 by default
+  void setMaxIterations(int _maxIterations) { mMaxIterations = _maxIterations; }
+
+private:
+  /// \brief Append constraint _id, whose normal is transformed in mD, to the
+  /// active set, updating mJ and mR. Returns false and leaves the active set
+  /// as it was if the normal depends on the active ones.
+  bool addConstraint(int _id);
+
+  /// \brief Remove the constraint at position _position of the active set
+  void deleteConstraint(int _position);
+
+  /// \brief mD, mZ and mRU for the constraint normal _normal
+  void computeStep(const Eigen::VectorXd& _normal);
+
+  int mMaxIterations;
+  int mIterations;
+
+  /// \brief Active constraints: equalities are 0 to 5, row i of _C is 6 + i
+  std::vector<int> mActive;
+  std::vector<int> mWarmStart;
+
+  /// \brief Scratch, kept so that repeated solves do not allocate
+  Eigen::MatrixXd mG;
+  Eigen::VectorXd mg;
+  Eigen::LLT<Eigen::MatrixXd> mLLT;
+  Eigen::MatrixXd mJ;
+  Eigen::MatrixXd mR;
+  Eigen::VectorXd mU;
+  Eigen::VectorXd mD;
+  Eigen::VectorXd mZ;
+  Eigen::VectorXd mRU;
+  Eigen::VectorXd mS;
+  Eigen::VectorXd mNormal;
+  Eigen::VectorXd mRowNorms;
+  std::vector<char> mBlocked;
+  double mRNorm;
+};
+
+#endif  // EXAMPLES_OPERATIONALSPACECONTROL_ACTIVESETQP_HPP_
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+//==========================================================================
+Arena::Arena(std::size_t _chunkSize)
+  : mChunkSize(_chunkSize), mNext(nullptr), mEnd(nullptr), mBytesUsed(0), mBytesReserved(0) {}
+
+//==========================================================================
+Arena::~Arena() {
+  for (std::size_t i = 0; i < mChunks.size(); ++i) std::free(mChunks[i]);
+}
+
+//==========================================================================
+void* Arena::allocate(std::size_t _bytes, std::size_t _alignment) {
+  std::uintptr_t next = reinterpret_cast<std::uintptr_t>(mNext);
+  std::uintptr_t aligned = (next + _alignment - 1) & ~(std::uintptr_t)(_alignment - 1);
+  if (mNext == nullptr || aligned + _bytes > reinterpret_cast<std::uintptr_t>(mEnd)) {
+    // Oversized blocks get a chunk of their own
+    const std::size_t size = std::max(mChunkSize, _bytes + 64);
+    char* chunk = static_cast<char*>(std::malloc(size));
+    if (chunk == nullptr) throw std::bad_alloc();
+    mChunks.push_back(chunk);
+    mBytesReserved += size;
+    mNext = chunk;
+    mEnd = chunk + size;
+    next = reinterpret_cast<std::uintptr_t>(mNext);
+    aligned = (next + _alignment - 1) & ~(std::uintptr_t)(_alignment - 1);
+  }
+  mBytesUsed += aligned + _bytes - next;
+  mNext = reinterpret_cast<char*>(aligned + _bytes);
+  return reinterpret_cast<void*>(aligned);
+}
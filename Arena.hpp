@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EXAMPLES_OPERATIONALSPACECONTROL_ARENA_HPP_
+#define EXAMPLES_OPERATIONALSPACECONTROL_ARENA_HPP_
+
+#include <cstddef>
+#include <vector>
+
+/// \brief Bump allocator for per-instance state: blocks are carved out of
+/// large chunks one after the other and only freed all together when the
+/// arena goes away. Objects created in it are not destroyed by it. Not
+/// thread safe.
+class Arena {
+public:
+  /// \brief Allocate chunks of at least _chunkSize bytes
+  explicit Arena(std::size_t _chunkSize = 1 << 20);
+
+  /// \brief Free all chunks
+  ~Arena();
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /// \brief _bytes of uninitialized memory aligned to _alignment, a power of
+  /// two no larger than 64
+  void* allocate(std::size_t _bytes, std::size_t _alignment = 16);
+
+  /// \brief Bytes handed out so far, alignment padding included
+  std::size_t getBytesUsed() const { return mBytesUsed; }
+
+  /// \brief Bytes of all chunks
+  std::size_t getBytesReserved() const { return mBytesReserved; }
+
+private:
+  std::size_t mChunkSize;
+  std::vector<char*> mChunks;
+
+  /// \brief Free space of the last chunk
+  char* mNext;
+  char* mEnd;
+
+  std::size_t mBytesUsed;
+  std::size_t mBytesReserved;
+};
+
+#endif  // EXAMPLES_OPERATIONALSPACECONTROL_ARENA_HPP_
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ClosedFormQP.hpp"
+
+//====================================================================
+template <typename Scalar>
+void stackClosedFormTasks(const Eigen::Matrix<double, 9, 30>& _dense,
+                          const Eigen::Matrix<double, 9, 1>& _denseB,
+                          const Eigen::Matrix<double, 30, 3>& _diagonals,
+                          const Eigen::Matrix<double, 30, 3>& _diagonalB,
+                          Eigen::Matrix<Scalar, Eigen::Dynamic, 30>* _P,
+                          Eigen::Matrix<Scalar, Eigen::Dynamic, 1>* _b) {
+  // Same size every tick, so only the first call allocates
+  _P->resize(9 + 3*30, 30);
+  _b->resize(9 + 3*30);
+  _P->template topRows<9>() = _dense.cast<Scalar>();
+  _b->template head<9>() = _denseB.cast<Scalar>();
+  _P->bottomRows(3*30).setZero();
+  for (int k = 0; k < 3; ++k) {
+    _P->block(9 + 30*k, 0, 30, 30).diagonal() = _diagonals.col(k).cast<Scalar>();
+    _b->segment(9 + 30*k, 30) = _diagonalB.col(k).cast<Scalar>();
+  }
+}
+
+//====================================================================
+template <typename Scalar>
+bool solveClosedFormQP(const Eigen::Matrix<Scalar, Eigen::Dynamic, 30>& _P,
+                       const Eigen::Matrix<Scalar, Eigen::Dynamic, 1>& _b,
+                       const Eigen::Matrix<double, 6, 30>& _A,
+                       const Eigen::Matrix<double, 6, 1>& _c,
+                       const Eigen::Matrix<double, 30, 1>& _x0, double _damping,
+                       Eigen::Matrix<double, 30, 1>* _x) {
+  typedef Eigen::Matrix<Scalar, 30, 30> Matrix30;
+  typedef Eigen::Matrix<Scalar, 30, 1> Vector30;
+  typedef Eigen::Matrix<Scalar, 6, 6> Matrix6;
+  typedef Eigen::Matrix<Scalar, 6, 1> Vector6;
+
+  // Normal equations of the tasks, the bulk of the work
+  const Eigen::Matrix<Scalar, Eigen::Dynamic, 30>& P = _P;
+  const Eigen::Matrix<Scalar, 6, 30> A = _A.cast<Scalar>();
+  const Scalar damping = static_cast<Scalar>(_damping);
+  Matrix30 H;
+  H.noalias() = P.transpose()*P;
+  H.diagonal().array() += damping;
+  Vector30 g;
+  g.noalias() = P.transpose()*_b;
+  g += damping*_x0.cast<Scalar>();
+
+  // Range-space solve of the KKT system: x = H^-1 (g - A^T nu) with
+  // (A H^-1 A^T) nu = A H^-1 g - c
+  Eigen::LLT<Matrix30> hessian(H);
+  if (hessian.info() != Eigen::Success) return false;
+  const Eigen::Matrix<Scalar, 30, 6> Y = hessian.solve(A.transpose());
+  const Matrix6 S = A*Y;
+  Eigen::LLT<Matrix6> schur(S);
+  if (schur.info() != Eigen::Success) return false;
+  const Vector30 xg = hessian.solve(g);
+  const Vector6 nu = schur.solve(A*xg - _c.cast<Scalar>());
+  const Vector30 x = xg - Y*nu;
+  if (!x.allFinite()) return false;
+
+  *_x = x.template cast<double>();
+  return true;
+}
+
+template void stackClosedFormTasks<float>(
+    const Eigen::Matrix<double, 9, 30>&, const Eigen::Matrix<double, 9, 1>&,
+    const Eigen::Matrix<double, 30, 3>&, const Eigen::Matrix<double, 30, 3>&,
+    Eigen::Matrix<float, Eigen::Dynamic, 30>*, Eigen::Matrix<float, Eigen::Dynamic, 1>*);
+template void stackClosedFormTasks<double>(
+    const Eigen::Matrix<double, 9, 30>&, const Eigen::Matrix<double, 9, 1>&,
+    const Eigen::Matrix<double, 30, 3>&, const Eigen::Matrix<double, 30, 3>&,
+    Eigen::Matrix<double, Eigen::Dynamic, 30>*, Eigen::Matrix<double, Eigen::Dynamic, 1>*);
+template bool solveClosedFormQP<float>(
+    const Eigen::Matrix<float, Eigen::Dynamic, 30>&, const Eigen::Matrix<float, Eigen::Dynamic, 1>&,
+    const Eigen::Matrix<double, 6, 30>&, const Eigen::Matrix<double, 6, 1>&,
+    const Eigen::Matrix<double, 30, 1>&, double, Eigen::Matrix<double, 30, 1>*);
+template bool solveClosedFormQP<double>(
+    const Eigen::Matrix<double, Eigen::Dynamic, 30>&, const Eigen::Matrix<double, Eigen::Dynamic, 1>&,
+    const Eigen::Matrix<double, 6, 30>&, const Eigen::Matrix<double, 6, 1>&,
+    const Eigen::Matrix<double, 30, 1>&, double, Eigen::Matrix<double, 30, 1>*);
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EXAMPLES_OPERATIONALSPACECONTROL_CLOSEDFORMQP_HPP_
+#define EXAMPLES_OPERATIONALSPACECONTROL_CLOSEDFORMQP_HPP_
+
+#include <Eigen/Eigen>
+
+/// \brief Scalar type of the controller's closed-form solve. The physics and
+/// the task kinematics stay in double either way.
+#ifdef CONTROLLER_USE_FLOAT
+typedef float ControllerScalar;
+#else
+typedef double ControllerScalar;
+#endif
+
+/// \brief Stack the tasks of the controller QP into _P and _b in Scalar
+/// precision: the dense rows _dense (end effectors and balance) on top of
+/// the diagonal tasks with weights _diagonals.col(k) (pose, speed regulator,
+/// regulator). Only the dense rows and the weights are converted, so the
+/// 99 x 30 P is never cast as a whole.
+template <typename Scalar>
+void stackClosedFormTasks(const Eigen::Matrix<double, 9, 30>& _dense,
+                          const Eigen::Matrix<double, 9, 1>& _denseB,
+                          const Eigen::Matrix<double, 30, 3>& _diagonals,
+                          const Eigen::Matrix<double, 30, 3>& _diagonalB,
+                          Eigen::Matrix<Scalar, Eigen::Dynamic, 30>* _P,
+                          Eigen::Matrix<Scalar, Eigen::Dynamic, 1>* _b);
+
+/// \brief Solve the controller QP over ddq and the constraint forces
+///   min 1/2 |_P x - _b|^2 + _damping/2 |x - _x0|^2   s.t.   _A x = _c
+/// in closed form, in Scalar precision. The damping toward the previous
+/// solution _x0 makes the problem well posed: the tasks leave the base,
+/// wheel and constraint force directions to the equality constraints alone.
+/// Returns false, leaving _x untouched, if a factorization fails.
+template <typename Scalar>
+bool solveClosedFormQP(const Eigen::Matrix<Scalar, Eigen::Dynamic, 30>& _P,
+                       const Eigen::Matrix<Scalar, Eigen::Dynamic, 1>& _b,
+                       const Eigen::Matrix<double, 6, 30>& _A,
+                       const Eigen::Matrix<double, 6, 1>& _c,
+                       const Eigen::Matrix<double, 30, 1>& _x0, double _damping,
+                       Eigen::Matrix<double, 30, 1>* _x);
+
+extern template void stackClosedFormTasks<float>(
+    const Eigen::Matrix<double, 9, 30>&, const Eigen::Matrix<double, 9, 1>&,
+    const Eigen::Matrix<double, 30, 3>&, const Eigen::Matrix<double, 30, 3>&,
+    Eigen::Matrix<float, Eigen::Dynamic, 30>*, Eigen::Matrix<float, Eigen::Dynamic, 1>*);
+extern template void stackClosedFormTasks<double>(
+    const Eigen::Matrix<double, 9, 30>&, const Eigen::Matrix<double, 9, 1>&,
+    const Eigen::Matrix<double, 30, 3>&, const Eigen::Matrix<double, 30, 3>&,
+    Eigen::Matrix<double, Eigen::Dynamic, 30>*, Eigen::Matrix<double, Eigen::Dynamic, 1>*);
+extern template bool solveClosedFormQP<float>(
+    const Eigen::Matrix<float, Eigen::Dynamic, 30>&, const Eigen::Matrix<float, Eigen::Dynamic, 1>&,
+    const Eigen::Matrix<double, 6, 30>&, const Eigen::Matrix<double, 6, 1>&,
+    const Eigen::Matrix<double, 30, 1>&, double, Eigen::Matrix<double, 30, 1>*);
+extern template bool solveClosedFormQP<double>(
+    const Eigen::Matrix<double, Eigen::Dynamic, 30>&, const Eigen::Matrix<double, Eigen::Dynamic, 1>&,
+    const Eigen::Matrix<double, 6, 30>&, const Eigen::Matrix<double, 6, 1>&,
+    const Eigen::Matrix<double, 30, 1>&, double, Eigen::Matrix<double, 30, 1>*);
+
+#endif  // EXAMPLES_OPERATIONALSPACECONTROL_CLOSEDFORMQP_HPP_
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CommandChannel.hpp"
+
+#include <time.h>
+#include <iostream>
+#include <new>
+
+//==========================================================================
+uint64_t monotonicNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec)*1000000000ull + ts.tv_nsec;
+}
+
+//==========================================================================
+CommandWriter* CommandWriter::create(const std::string& _name) {
+  SharedMemory* shm = SharedMemory::create(_name, sizeof(CommandRing));
+  if (shm == nullptr) return nullptr;
+  return new CommandWriter(shm);
+}
+
+//==========================================================================
+CommandWriter::CommandWriter(SharedMemory* _shm)
+  : mShm(_shm),
+    mSequence(0) {
+  // The object may still be mapped by readers of a previous writer. Reset the
+  // ring before publishing the new generation, so that a reader which sees
+  // the generation change also sees an empty ring.
+  mRing = new (mShm->data()) CommandRing;
+  mRing->head.store(0, std::memory_order_relaxed);
+  for (uint32_t i = 0; i < CommandRing::kCapacity; ++i)
+    mRing->slots[i].sequence.store(0, std::memory_order_relaxed);
+  mRing->capacity = CommandRing::kCapacity;
+  mRing->generation.store(monotonicNs(), std::memory_order_release);
+  std::atomic_thread_fence(std::memory_order_release);
+  mRing->magic = CommandRing::kMagic;
+}
+
+//==========================================================================
+CommandWriter::~CommandWriter() {
+  delete mShm;
+}
+
+//==========================================================================
+void CommandWriter::write(Command _command) {
+  if (_command.stampNs == 0) _command.stampNs = monotonicNs();
+
+  ++mSequence;
+  CommandSlot& slot = mRing->slots[mSequence % CommandRing::kCapacity];
+  slot.sequence.store(2*mSequence - 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.command = _command;
+  slot.sequence.store(2*mSequence, std::memory_order_release);
+  mRing->head.store(mSequence, std::memory_order_release);
+}
+
+//==========================================================================
+CommandReader* CommandReader::open(const std::string& _name, uint64_t _staleAfterNs) {
+  SharedMemory* shm = map(_name);
+  if (shm == nullptr) return nullptr;
+  return new CommandReader(_name, shm, _staleAfterNs);
+}
+
+//==========================================================================
+SharedMemory* CommandReader::map(const std::string& _name) {
+  SharedMemory* shm = SharedMemory::open(_name, sizeof(CommandRing));
+  if (shm == nullptr) return nullptr;
+  const CommandRing* ring = static_cast<const CommandRing*>(shm->data());
+  if (ring->magic != CommandRing::kMagic || ring->capacity != CommandRing::kCapacity) {
+    std::cerr << "[command] " << _name << " is not a command ring" << std::endl;
+    delete shm;
+    return nullptr;
+  }
+  return shm;
+}
+
+//==========================================================================
+CommandReader::CommandReader(const std::string& _name, SharedMemory* _shm,
+                             uint64_t _staleAfterNs)
+  : mName(_name),
+    mShm(_shm),
+    mRing(static_cast<const CommandRing*>(_shm->data())),
+    mStaleAfterNs(_staleAfterNs),
+    mLastSequence(0),
+    mSkipped(0),
+    mStale(0) {
+  reset(mRing->generation.load(std::memory_order_acquire));
+}
+
+//==========================================================================
+CommandReader::~CommandReader() {
+  delete mShm;
+}
+
+//==========================================================================
+void CommandReader::reset(uint64_t _generation) {
+  mGeneration = _generation;
+  mLastSequence = 0;
+  mLast.stampNs = 0;
+  mLast.flags = 0;
+}
+
+//==========================================================================
+bool CommandReader::checkWriter() {
+  SharedMemory* shm = map(mName);
+  if (shm == nullptr) return false;
+  const CommandRing* ring = static_cast<const CommandRing*>(shm->data());
+  uint64_t generation = ring->generation.load(std::memory_order_acquire);
+  if (generation == mGeneration) {
+    delete shm;
+    return false;
+  }
+  delete mShm;
+  mShm = shm;
+  mRing = ring;
+  reset(generation);
+  return true;
+}
+
+//==========================================================================
+bool CommandReader::poll() {
+  // A writer that takes over the object resets the ring in place, so the
+  // mapping stays valid
+  uint64_t generation = mRing->generation.load(std::memory_order_acquire);
+  if (generation != mGeneration) reset(generation);
+
+  // The writer may lap a slot while we copy it; retry a few times with the
+  // newest head and otherwise keep what we have.
+  for (int attempt = 0; attempt < 4; ++attempt) {
+    uint64_t head = mRing->head.load(std::memory_order_acquire);
+    if (head == 0 || head == mLastSequence) break;
+
+    const CommandSlot& slot = mRing->slots[head % CommandRing::kCapacity];
+    uint64_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before != 2*head) continue;
+    Command copy = slot.command;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != before) continue;
+
+    if (mLastSequence != 0 && head > mLastSequence + 1)
+      mSkipped += head - mLastSequence - 1;
+    mLastSequence = head;
+    mLast = copy;
+    break;
+  }
+
+  if (mLastSequence != 0 && monotonicNs() - mLast.stampNs <= mStaleAfterNs) return true;
+  if (mLastSequence != 0) ++mStale;
+  return false;
+}
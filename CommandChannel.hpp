@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EXAMPLES_OPERATIONALSPACECONTROL_COMMANDCHANNEL_HPP_
+#define EXAMPLES_OPERATIONALSPACECONTROL_COMMANDCHANNEL_HPP_
+
+#include <Eigen/Eigen>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "SharedMemory.hpp"
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "command channel needs lock-free 64-bit atomics");
+
+/// \brief Targets sent by an external planner. Both targets are expressed in
+/// the heading frame of the robot (frame 0), like MyWindow::mTargetPosition.
+struct Command {
+  /// \brief Monotonic time (CLOCK_MONOTONIC, ns) at which the planner wrote it
+  uint64_t stampNs;
+
+  /// \brief End-effector target
+  double eeTarget[3];
+
+  /// \brief Body COM target, only x (forward) and z (height) are tracked
+  double comTarget[3];
+
+  /// \brief Bitwise OR of Command::Flags
+  uint32_t flags;
+
+  enum Flags {
+    EE_VALID = 1u << 0,
+    COM_VALID = 1u << 1
+  };
+};
+
+/// \brief One ring entry guarded by its own sequence word: odd while the
+/// writer is filling it, 2*seq once command number seq is complete.
+struct CommandSlot {
+  std::atomic<uint64_t> sequence;
+  Command command;
+};
+
+/// \brief Layout of the shared memory object
+struct CommandRing {
+  static const uint32_t kMagic = 0x4b434d44;  // "KCMD"
+  static const uint32_t kCapacity = 64;
+
+  uint32_t magic;
+  uint32_t capacity;
+
+  /// \brief Identifies the writer that set the ring up (its creation time in
+  /// ns). A restarted writer reuses the object and changes it, so readers
+  /// know to drop the sequence numbers of the previous one.
+  alignas(64) std::atomic<uint64_t> generation;
+
+  /// \brief Number of the last completely written command (0 = none yet)
+  alignas(64) std::atomic<uint64_t> head;
+
+  alignas(64) CommandSlot slots[kCapacity];
+};
+
+/// \brief Current CLOCK_MONOTONIC time in ns. Served by the vDSO, so it does
+/// not enter the kernel.
+uint64_t monotonicNs();
+
+/// \brief Single producer side of the channel, used by planners
+class CommandWriter {
+public:
+  /// \brief Create the shared memory object _name, or take over the one a
+  /// previous writer left behind. Returns nullptr on failure.
+  static CommandWriter* create(const std::string& _name);
+
+  /// \brief Destructor. The object stays in place so that readers keep their
+  /// mapping and a restarted writer picks it up again.
+  ~CommandWriter();
+
+  /// \brief Publish _command; its stampNs is set to the current time if zero
+  void write(Command _command);
+
+private:
+  explicit CommandWriter(SharedMemory* _shm);
+
+  SharedMemory* mShm;
+
+  CommandRing* mRing;
+
+  uint64_t mSequence;
+};
+
+/// \brief Consumer side of the channel. poll() only touches the mapping and
+/// the vDSO clock, so it is safe to call from the 1 kHz control tick.
+class CommandReader {
+public:
+  /// \brief Map the object _name. Returns nullptr if no writer created it yet.
+  /// Commands older than _staleAfterNs are treated as stale.
+  static CommandReader* open(const std::string& _name, uint64_t _staleAfterNs);
+
+  /// \brief Destructor
+  ~CommandReader();
+
+  /// \brief Pick up the newest command, if any. Returns true when it is fresh.
+  /// When the writer stops or falls behind, the last command is held and
+  /// false is returned. When a new writer takes over the mapped object, the
+  /// previous writer's commands are forgotten. Makes no system calls.
+  bool poll();
+
+  /// \brief Look the name up again and switch to it if it now refers to an
+  /// object set up by a different writer, e.g. after the old one was unlinked
+  /// and created anew. Returns true if it switched. This maps the object, so
+  /// call it outside the control tick, for instance while commands are stale.
+  bool checkWriter();
+
+  /// \brief Last command accepted by poll()
+  const Command& last() const { return mLast; }
+
+  /// \brief True once at least one command has been received
+  bool hasCommand() const { return mLastSequence != 0; }
+
+  /// \brief Commands superseded by a newer one before poll() saw them
+  uint64_t getNumSkipped() const { return mSkipped; }
+
+  /// \brief Polls that found the newest command too old
+  uint64_t getNumStale() const { return mStale; }
+
+private:
+  CommandReader(const std::string& _name, SharedMemory* _shm, uint64_t _staleAfterNs);
+
+  /// \brief Map _name and check that it holds a command ring
+  static SharedMemory* map(const std::string& _name);
+
+  /// \brief Forget the commands of the previous writer and follow the one of
+  /// _generation
+  void reset(uint64_t _generation);
+
+  std::string mName;
+
+  SharedMemory* mShm;
+
+  const CommandRing* mRing;
+
+  /// \brief Generation of the writer whose sequence numbers we track
+  uint64_t mGeneration;
+
+  uint64_t mStaleAfterNs;
+
+  uint64_t mLastSequence;
+
+  Command mLast;
+
+  uint64_t mSkipped;
+
+  uint64_t mStale;
+};
+
+#endif  // EXAMPLES_OPERATIONALSPACECONTROL_COMMANDCHANNEL_HPP_
@@ -30,13 +30,17 @@
  */
 
 #include "Controller.hpp"
+#include <chrono>
+#include <cmath>
+#include <limits>
 #include <nlopt.hpp>
 #include <string>
 
 //==========================================================================
 Controller::Controller(dart::dynamics::SkeletonPtr _robot,
                        dart::dynamics::BodyNode* _LeftendEffector,
-                       dart::dynamics::BodyNode* _RightendEffector)
+                       dart::dynamics::BodyNode* _RightendEffector,
+                       Arena* _arena)
   : mRobot(_robot),
     mLeftEndEffector(_LeftendEffector),
     mRightEndEffector(_RightendEffector)
@@ -46,9 +50,9 @@ Controller::Controller(dart::dynamics::SkeletonPtr _robot,
   assert(_RightendEffector != nullptr);
 
   int dof = mRobot->getNumDofs();
-  std::cout << "[controller] DoF: " << dof << std::endl;
 
   mForces.setZero(19);
+  mTaskLosses.setZero();
   mKp.setZero();
   mKv.setZero();
 
@@ -58,6 +62,35 @@ Controller::Controller(dart::dynamics::SkeletonPtr _robot,
   }
 
   mSteps = 0;
+  mKpxCOM = 750.0;
+  mKvxCOM = 250.0;
+  ddq_lambda.setZero();
+  mSolver = SLSQP;
+  mDamping = 1e-4;
+  mVerbose = true;
+  mLazyQTolerance = mLazyDqTolerance = mLazyTargetTolerance = 0.0;
+  mLazyMaxSkips = 0;
+  mSkipsSinceSolve = 0;
+  mNumSolves = mNumSkippedSolves = 0;
+  mSolvedQ.setZero();
+  mSolvedDq.setZero();
+  mSolvedTargets.setZero();
+
+  // Torque limits from the URDF efforts; unset ones are unlimited
+  const double inf = std::numeric_limits<double>::infinity();
+  Eigen::VectorXd forceUpperLimits = mRobot->getForceUpperLimits();
+  for (int i = 0; i < 19; ++i)
+    mTorqueLimits(i) = (forceUpperLimits(6 + i) > 0.0) ? forceUpperLimits(6 + i) : inf;
+  mAccelerationLimit = 10.0;
+  mFrictionCoefficient = 0.0;
+  mNumClampedTicks = 0;
+
+  mMode = WHOLE_BODY;
+  mFallbackBudget = 0.0;
+  mFallbackProbeEvery = 100;
+  mFallbackProbesToRecover = 3;
+  mTicksSinceProbe = mGoodProbes = 0;
+  mHoldQ = mRobot->getPositions();
 
   mLWheel = mRobot->getBodyNode("LWheel");
   mRWheel = mRobot->getBodyNode("RWheel");
@@ -68,21 +101,40 @@ Controller::Controller(dart::dynamics::SkeletonPtr _robot,
     mRobot->getMass()*mRobot->getCOM() - mLWheel->getMass()*mLWheel->getCOM() - mRWheel->getMass()*mLWheel->getCOM()) \
     /(mRobot->getMass() - mLWheel->getMass() - mRWheel->getMass());
   zCOMInit = bodyCOM(2) - qInit(5);
+  mCOMTarget << 0.0, 0.0, zCOMInit;
+
+  // Balance-only gains of a pendulum of the body mass at the COM height:
+  // stiffer than gravity (3 m g) and about critically damped
+  const double bodyMass = mRobot->getMass() - mLWheel->getMass() - mRWheel->getMass();
+  const double gravity = 9.81;
+  mBalanceKp = 3.0*bodyMass*gravity;
+  mBalanceKd = 2.0*std::sqrt(2.0*gravity/zCOMInit)*bodyMass*zCOMInit;
+  mBalanceSpeedGain = 0.1;
+  mBalanceYawKd = 20.0;
+  mHoldKp = 200.0;
+  mHoldKv = 20.0;
   // Remove position limits
   for(int i = 6; i < dof-1; ++i)
     _robot->getJoint(i)->setPositionLimitEnforced(false);
-  std::cout << "Position Limit Enforced set to false" << std::endl;
 
   // Set joint damping
   for(int i = 6; i < dof-1; ++i)
     _robot->getJoint(i)->setDampingCoefficient(0, 0.5);
-  std::cout << "Damping coefficients set" << std::endl;
 
-  dqFilt = new filter(25, 100);
+  const int filterSize = 100;
+  dqFilt = new filter(25, filterSize, _arena ? static_cast<double*>(
+    _arena->allocate(25*filterSize*sizeof(double))) : nullptr);
 }
 
 //=========================================================================
-Controller::~Controller() {}
+Controller::~Controller() {
+  delete dqFilt;
+}
+
+//=========================================================================
+// Dofs driven by mForces
+static const std::vector<std::size_t> actuatedDofs{6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24};
+
 //=========================================================================
 struct OptParams {
   Eigen::MatrixXd P;
@@ -145,6 +197,65 @@ double optFunc(const std::vector<double> &x, std::vector<double> &grad, void *my
 
 //=========================================================================
 void Controller::update(const Eigen::Vector3d& _targetPosition) {
+  update(_targetPosition, Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero());
+}
+
+//=========================================================================
+void Controller::update(const Eigen::Vector3d& _targetPosition,
+                        const Eigen::Vector3d& _targetVelocity,
+                        const Eigen::Vector3d& _targetAcceleration) {
+  dqFilt->AddSample(mRobot->getVelocities());
+
+  // increase the step counter
+  mSteps++;
+  if (mVerbose && mSteps == 1) {
+    std::cout << "[controller] DoF: " << mRobot->getNumDofs() << std::endl;
+    std::cout << "Position Limit Enforced set to false" << std::endl;
+    std::cout << "Damping coefficients set" << std::endl;
+  }
+
+  // In balance-only mode, probe the whole-body solve now and then
+  if (mMode == BALANCE_ONLY) {
+    if (mFallbackBudget <= 0.0 || mFallbackProbeEvery == 0
+        || ++mTicksSinceProbe < mFallbackProbeEvery) {
+      updateBalanceOnly();
+      return;
+    }
+    mTicksSinceProbe = 0;
+  }
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  bool solved = updateWholeBody(_targetPosition, _targetVelocity, _targetAcceleration);
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  if (mFallbackBudget <= 0.0) return;
+  const bool ok = solved && elapsed <= mFallbackBudget;
+
+  if (mMode == WHOLE_BODY) {
+    if (!ok) {
+      if (mVerbose)
+        std::cout << "[controller] Whole-body solve " << (solved ? "overran" : "failed")
+                  << " (" << elapsed*1e3 << " ms), balancing only" << std::endl;
+      mMode = BALANCE_ONLY;
+      mHoldQ = mRobot->getPositions();
+      mTicksSinceProbe = mGoodProbes = 0;
+      mSkipsSinceSolve = mLazyMaxSkips;
+      updateBalanceOnly();
+    }
+  }
+  else if (ok && ++mGoodProbes >= mFallbackProbesToRecover) {
+    if (mVerbose) std::cout << "[controller] Whole-body solve recovered" << std::endl;
+    mMode = WHOLE_BODY;
+  }
+  else {
+    if (!ok) mGoodProbes = 0;
+    updateBalanceOnly();
+  }
+}
+
+//=========================================================================
+bool Controller::updateWholeBody(const Eigen::Vector3d& _targetPosition,
+                                 const Eigen::Vector3d& _targetVelocity,
+                                 const Eigen::Vector3d& _targetAcceleration) {
 
   using namespace dart;
   using namespace std;  
@@ -152,11 +263,10 @@ void Controller::update(const Eigen::Vector3d& _targetPosition) {
   const int nConstraints = 5;
   Eigen::VectorXd q = mRobot->getPositions();
   Eigen::VectorXd dqUnFilt    = mRobot->getVelocities();                // n x 1
-  dqFilt->AddSample(dqUnFilt);
   Eigen::VectorXd dq = dqFilt->average;
   double wEER = 0.01, wEEL = 0.01, wSpeedReg = 0.0, wReg = 0.0, wPose = 0.0;
   Eigen::DiagonalMatrix<double, 3> wBal(1.0, 0.0, 1.0);
-  double KpxCOM = 750.0, KvxCOM = 250.0;
+  double KpxCOM = mKpxCOM, KvxCOM = mKvxCOM;
   double KvSpeedReg = 0.01; // Speed Reg
   double KpPose = 10.0, KvPose = 0.0;
   Eigen::Matrix<double, 4, 4> baseTf = mRobot->getBodyNode(0)->getTransform().matrix();
@@ -164,16 +274,34 @@ void Controller::update(const Eigen::Vector3d& _targetPosition) {
   Eigen::Vector3d dxyz0 = baseTf.matrix().block<3,3>(0,0)*dq.segment(3,3); // velocity of frame 0 in the world frame represented in the world frame
 
 
-  // increase the step counter
-  mSteps++;
-  //cout << mSteps << endl;
+  // Lazy solve: while the state and the targets stay close to those of the
+  // last full solve, keep its solution and refresh only the cheap terms
+  Eigen::Matrix<double, 12, 1> targets;
+  targets << _targetPosition, _targetVelocity, _targetAcceleration, mCOMTarget;
+  if (mSkipsSinceSolve < mLazyMaxSkips
+      && (q - mSolvedQ).cwiseAbs().maxCoeff() < mLazyQTolerance
+      && (dq - mSolvedDq).cwiseAbs().maxCoeff() < mLazyDqTolerance
+      && (targets - mSolvedTargets).cwiseAbs().maxCoeff() < mLazyTargetTolerance) {
+    ++mSkipsSinceSolve;
+    ++mNumSkippedSolves;
+    Eigen::VectorXd h = mRobot->getCoriolisAndGravityForces();
+    Eigen::MatrixXd J = computeConstraintJacobian(baseTf);
+    mForces << (mProblem.M.block<19, 25>(6,0)*ddq_lambda.head(25) + h.tail(19) - (J.block<5, 19>(0,6).transpose())*ddq_lambda.tail(5));
+    applyForces();
+    return true;
+  }
+  mSkipsSinceSolve = 0;
+  ++mNumSolves;
+  mSolvedQ = q;
+  mSolvedDq = dq;
+  mSolvedTargets = targets;
 
   // Rotation Transform of Frame 0
   double psi =  atan2(baseTf(0,0), -baseTf(1,0));
   Eigen::Transform<double, 3, Eigen::Affine> Tf0 = Eigen::Transform<double, 3, Eigen::Affine>::Identity();
   Tf0.rotate(Eigen::AngleAxisd(psi, Eigen::Vector3d::UnitZ()));
   Eigen::Matrix<double, 3, 3> Rot0 = Tf0.matrix().block<3, 3>(0, 0).transpose();
-  if(mSteps==1){
+  if(mVerbose && mSteps==1){
   cout << "Correct Rot0:" << endl;
   for(int i=0; i<3; i++) { for(int j=0; j<3; j++) { cout << Rot0(i,j) << ", "; } cout << endl;  }
     cout << "Our Rot0:" << endl;
@@ -191,109 +319,139 @@ void Controller::update(const Eigen::Vector3d& _targetPosition) {
   
   // xEEref
   Eigen::VectorXd xEEref = _targetPosition;
-  if(mSteps == 1) { cout << "xEEref: " << xEEref(0) << ", " << xEEref(1) << ", " << xEEref(2) << endl; }
+  const Eigen::Vector3d& dxEEref = _targetVelocity;
+  const Eigen::Vector3d& ddxEEref = _targetAcceleration;
+  if(mVerbose && mSteps == 1) { cout << "xEEref: " << xEEref(0) << ", " << xEEref(1) << ", " << xEEref(2) << endl; }
   
   // ********************************* Left arm
   // Zero Columns
   Eigen::Vector3d zeroCol(0.0, 0.0, 0.0);
   Eigen::Matrix<double, 3, 7> zero7Col;
   zero7Col << zeroCol, zeroCol, zeroCol, zeroCol, zeroCol, zeroCol, zeroCol;
-  
-  // x, dx, ddxref
-  Eigen::Vector3d xEEL = Rot0*(mLeftEndEffector->getTransform().translation() - xyz0);
-  Eigen::Vector3d dxEEL = Rot0*(mLeftEndEffector->getLinearVelocity() - dxyz0);
-  Eigen::Vector3d ddxEELref = -mKp*(xEEL - xEEref) - mKv*dxEEL;
 
-  // Jacobian
-  math::LinearJacobian JEEL_small = mLeftEndEffector->getLinearJacobian(); 
+#ifdef KRANG_CODEGEN
+  mKinematics.update(q, dqUnFilt, dq);
+#else
+  // Drift terms of all three tasks from one pass over the joints
+  Eigen::Vector3d dJEELdq_world, dJEERdq_world, dJCOMdq_world;
+  computeDriftTerms(dq, &dJEELdq_world, &dJEERdq_world, &dJCOMdq_world);
+#endif
+
+  // Position, velocity, Jacobian and Jacobian derivative times dq in the world frame
+#ifdef KRANG_CODEGEN
+  const Eigen::Vector3d& xEEL_world = mKinematics.xEEL;
+  const Eigen::Vector3d& dxEEL_world = mKinematics.dxEEL;
+  const Eigen::Matrix<double, 3, 25>& JEEL_world = mKinematics.JEEL;
+  const Eigen::Vector3d& dJEELdq_world = mKinematics.dJEELdq;
+#else
+  Eigen::Vector3d xEEL_world = mLeftEndEffector->getTransform().translation();
+  Eigen::Vector3d dxEEL_world = mLeftEndEffector->getLinearVelocity();
+  math::LinearJacobian JEEL_small = mLeftEndEffector->getLinearJacobian();
   Eigen::Matrix<double, 3, 25> JEEL_world;
   JEEL_world << JEEL_small.block<3,1>(0,0), zero7Col, JEEL_small.block<3,2>(0,6), zeroCol, JEEL_small.block<3,7>(0,8), zero7Col;
+#endif
+
+  // x, dx, ddxref
+  Eigen::Vector3d xEEL = Rot0*(xEEL_world - xyz0);
+  Eigen::Vector3d dxEEL = Rot0*(dxEEL_world - dxyz0);
+  Eigen::Vector3d ddxEELref = ddxEEref - mKp*(xEEL - xEEref) - mKv*(dxEEL - dxEEref);
+
+  // Jacobian
   Eigen::Matrix<double, 3, 25> JEEL;
   JEEL = Rot0*JEEL_world;
-  
-  // Jacobian Derivative
-  math::LinearJacobian dJEEL_small = mLeftEndEffector->getLinearJacobianDeriv(); 
-  Eigen::Matrix<double, 3, 25> dJEEL_world;
-  dJEEL_world << dJEEL_small.block<3,1>(0,0), zero7Col, dJEEL_small.block<3,2>(0,6), zeroCol, dJEEL_small.block<3,7>(0,8), zero7Col;
-  Eigen::Matrix<double, 3, 25> dJEEL;
-  dJEEL = dRot0*JEEL_world + Rot0*dJEEL_world;
+
+  // Jacobian Derivative times dq
+  Eigen::Vector3d dJEELdq = dRot0*(JEEL_world*dq) + Rot0*dJEELdq_world;
 
   // P and b
   Eigen::Matrix<double, 3, 30> PEEL;
   PEEL << wEEL*JEEL, zeroCol, zeroCol, zeroCol, zeroCol, zeroCol;
-  Eigen::VectorXd bEEL = -wEEL*(dJEEL*dq - ddxEELref);
-  
-  //*********************************** Right Arm 
+  Eigen::VectorXd bEEL = -wEEL*(dJEELdq - ddxEELref);
+
+  //*********************************** Right Arm
+  // Position, velocity, Jacobian and Jacobian derivative times dq in the world frame
+#ifdef KRANG_CODEGEN
+  const Eigen::Vector3d& xEER_world = mKinematics.xEER;
+  const Eigen::Vector3d& dxEER_world = mKinematics.dxEER;
+  const Eigen::Matrix<double, 3, 25>& JEER_world = mKinematics.JEER;
+  const Eigen::Vector3d& dJEERdq_world = mKinematics.dJEERdq;
+#else
+  Eigen::Vector3d xEER_world = mRightEndEffector->getTransform().translation();
+  Eigen::Vector3d dxEER_world = mRightEndEffector->getLinearVelocity();
+  math::LinearJacobian JEER_small = mRightEndEffector->getLinearJacobian();
+  Eigen::Matrix<double, 3, 25> JEER_world;
+  JEER_world << JEER_small.block<3,1>(0,0), zero7Col, JEER_small.block<3,2>(0,6), zeroCol, zero7Col, JEER_small.block<3,7>(0,8);
+#endif
+
   // x, dx, ddxref
-  Eigen::Vector3d xEER = Rot0*(mRightEndEffector->getTransform().translation() - xyz0);
-  Eigen::Vector3d dxEER = Rot0*(mRightEndEffector->getLinearVelocity() - dxyz0);
-  Eigen::Vector3d ddxEERref = -mKp*(xEER - xEEref) - mKv*dxEER;
+  Eigen::Vector3d xEER = Rot0*(xEER_world - xyz0);
+  Eigen::Vector3d dxEER = Rot0*(dxEER_world - dxyz0);
+  Eigen::Vector3d ddxEERref = ddxEEref - mKp*(xEER - xEEref) - mKv*(dxEER - dxEEref);
 
   // Jacobian
-  math::LinearJacobian JEER_small = mRightEndEffector->getLinearJacobian(); 
-  Eigen::Matrix<double, 3, 25> JEER_world;
-  JEER_world << JEER_small.block<3,1>(0,0), zero7Col, JEER_small.block<3,2>(0,6), zeroCol, zero7Col, JEER_small.block<3,7>(0,8);
   Eigen::Matrix<double, 3, 25> JEER;
   JEER = Rot0*JEER_world;
-  
-  // Jacobian Derivative
-  math::LinearJacobian dJEER_small = mRightEndEffector->getLinearJacobianDeriv(); 
-  Eigen::Matrix<double, 3, 25> dJEER_world;
-  dJEER_world << dJEER_small.block<3,1>(0,0), zero7Col, dJEER_small.block<3,2>(0,6), zeroCol, zero7Col, dJEER_small.block<3,7>(0,8);
-  Eigen::Matrix<double, 3, 25> dJEER;
-  dJEER = dRot0*JEER_world + Rot0*dJEER_world;
+
+  // Jacobian Derivative times dq
+  Eigen::Vector3d dJEERdq = dRot0*(JEER_world*dq) + Rot0*dJEERdq_world;
 
   // P and b
   Eigen::Matrix<double, 3, 30> PEER;
   PEER << wEER*JEER, zeroCol, zeroCol, zeroCol, zeroCol, zeroCol;
-  Eigen::VectorXd bEER = -wEER*(dJEER*dq - ddxEERref);
+  Eigen::VectorXd bEER = -wEER*(dJEERdq - ddxEERref);
+
 
-  
   //*********************************** Balance
   // Excluding wheels from COM Calculation
+#ifdef KRANG_CODEGEN
+  const Eigen::Vector3d& bodyCOM = mKinematics.bodyCOM;
+  const Eigen::Vector3d& bodyCOMLinearVelocity = mKinematics.bodyCOMLinearVelocity;
+#else
   Eigen::Vector3d bodyCOM = ( \
     mRobot->getMass()*mRobot->getCOM() - mLWheel->getMass()*mLWheel->getCOM() - mRWheel->getMass()*mLWheel->getCOM()) \
     /(mRobot->getMass() - mLWheel->getMass() - mRWheel->getMass());
   Eigen::Vector3d bodyCOMLinearVelocity = ( \
     mRobot->getMass()*mRobot->getCOMLinearVelocity() - mLWheel->getMass()*mLWheel->getCOMLinearVelocity() - mRWheel->getMass()*mLWheel->getCOMLinearVelocity())  \
     /(mRobot->getMass() - mLWheel->getMass() - mRWheel->getMass());
-  
+#endif
+
   // x, dx, ddxref
   double xCOM = (Rot0*(bodyCOM - xyz0))(0);
   double dxCOM = (Rot0*(bodyCOMLinearVelocity - dxyz0))(0);
-  double ddxCOMref = -KpxCOM*xCOM - KvxCOM*dxCOM;
-  
+  double ddxCOMref = -KpxCOM*(xCOM - mCOMTarget(0)) - KvxCOM*dxCOM;
+
   double zCOM = (Rot0*(bodyCOM - xyz0))(2);
   double dzCOM = (Rot0*(bodyCOMLinearVelocity - dxyz0))(2);
-  double ddzCOMref = -KpxCOM*(zCOM - zCOMInit)- KvxCOM*dzCOM;
-  
-  // Jacobian
-  Eigen::MatrixXd JCOM_full = mRobot->getCOMLinearJacobian(); 
+  double ddzCOMref = -KpxCOM*(zCOM - mCOMTarget(2))- KvxCOM*dzCOM;
+
+  // Jacobian and Jacobian derivative times dq in the world frame
+#ifdef KRANG_CODEGEN
+  const Eigen::Matrix<double, 3, 25>& JCOM_world = mKinematics.JCOM;
+  const Eigen::Vector3d& dJCOMdq_world = mKinematics.dJCOMdq;
+#else
+  Eigen::MatrixXd JCOM_full = mRobot->getCOMLinearJacobian();
   Eigen::Matrix<double, 3, 25> JCOM_body;
   JCOM_body << JCOM_full.block<3,1>(0,0), zero7Col, JCOM_full.block<3,17>(0,8);
+  Eigen::Matrix<double, 3, 25> JCOM_world;
+  JCOM_world = (mRobot->getMass()/(mRobot->getMass() - mLWheel->getMass() - mRWheel->getMass()))*JCOM_body;
+#endif
+
+  // Jacobian
   Eigen::MatrixXd JCOM;
-  JCOM = (mRobot->getMass()/(mRobot->getMass() - mLWheel->getMass() - mRWheel->getMass()))*Rot0*JCOM_body;
-  //Eigen::VectorXd JxCOM;
-  //JxCOM = JCOM.block<1,25>(0, 0);
-  
-  // Jacobian Derivative
-  Eigen::MatrixXd dJCOM_full = mRobot->getCOMLinearJacobianDeriv(); 
-  Eigen::Matrix<double, 3, 25> dJCOM_body;
-  dJCOM_body << dJCOM_full.block<3,1>(0,0), zero7Col, dJCOM_full.block<3,17>(0,8);
-  Eigen::MatrixXd dJCOM;
-  dJCOM = (mRobot->getMass()/(mRobot->getMass() - mLWheel->getMass() - mRWheel->getMass()))*(dRot0*JCOM_body + Rot0*dJCOM_body);
-  //Eigen::VectorXd dJxCOM;
-  //dJxCOM = dJCOM.block<1,25>(0, 0);
-
-  // P and b 
+  JCOM = Rot0*JCOM_world;
+
+  // Jacobian Derivative times dq
+  Eigen::Vector3d dJCOMdq = dRot0*(JCOM_world*dq) + Rot0*dJCOMdq_world;
+
+  // P and b
   Eigen::Matrix<double, 3, 30> PBal;
   PBal << wBal*JCOM, zeroCol, zeroCol, zeroCol, zeroCol, zeroCol;
   for(int i=0; i<30; i++) PBal(1,i) = 0;
   Eigen::Matrix<double, 3, 1> bBal;
   Eigen::Matrix<double, 3, 1> ddXCOMref;
   ddXCOMref << ddxCOMref, 0.0, ddzCOMref;
-  bBal << (wBal*(-dJCOM*dq + ddXCOMref));
-  
+  bBal << (wBal*(-dJCOMdq + ddXCOMref));
+
   // ***************************** Pose
   Eigen::MatrixXd wMatPose = Eigen::MatrixXd::Identity(30, 30);
   wMatPose(0,0) = 10*wPose; // Base Link Pitch
@@ -333,35 +491,15 @@ void Controller::update(const Eigen::Vector3d& _targetPosition) {
   Eigen::Matrix<double, 30, 1> bReg = Eigen::VectorXd::Zero(30); 
 
   // **************************** Constraint Jacobian
-  // Constraints:
-  //  0. dZ0 = 0                                               
-  //                                                              => dq_orig(4)*cos(qBody1) + dq_orig(5)*sin(qBody1) = 0
-  //  1. da3 + R/L*(dthL - dthR) = 0                           
-  //                                                              => dq_orig(1)*cos(qBody1) + dq_orig(2)*sin(qBody1) + R/L*(dq_orig(6) - dq_orig(7)) = 0 
-  //  2. da1*cos(psii) + da2*sin(psii) = 0                     
-  //                                                              => dq_orig(1)*sin(qBody1) - dq_orig(2)*cos(qBody1) = 0
-  //  3. dX0*sin(psii) - dY0*cos(psii) = 0                     
-  //                                                              => dq_orig(3) = 0
-  //  4. dX0*cos(psii) + dY0*sin(psii) - R/2*(dthL + dthR) = 0 
-  //                                                              => dq_orig(4)*sin(qBody1) - dq_orig(5)*cos(qBody1) - R/2*(dq_orig(6) + dq_orig(7) - 2*dq_orig(0)) = 0
-  double R = 0.265, L = 0.68;
-  double qBody1; 
-  qBody1 = atan2(baseTf(0,1)*cos(psi) + baseTf(1,1)*sin(psi), baseTf(2,1));
-  Eigen::MatrixXd J = Eigen::MatrixXd::Zero(5, 25);
-  J(0,4) = cos(qBody1); J(0,5) = sin(qBody1);
-  J(1,1) = cos(qBody1); J(1,2) = sin(qBody1); J(1,6) = R/L; J(1,7) = -R/L;
-  J(2,1) = sin(qBody1); J(2,2) = -cos(qBody1); 
-  J(3,3) = 1;
-  J(4,0) = R; J(4,4) = sin(qBody1); J(4,5) = -cos(qBody1); J(4,6) = -R/2; J(4,7) = -R/2; 
+  Eigen::MatrixXd J = computeConstraintJacobian(baseTf);
 
-  
   // ***************************** Inertia and Coriolis Matrices
   Eigen::MatrixXd M = mRobot->getMassMatrix();
   Eigen::VectorXd h = mRobot->getCoriolisAndGravityForces();
 
   // ***************************** QP
   OptParams optParams;
-  if(mSteps == 1) {
+  if(mVerbose && mSteps == 1) {
     cout << "PEER: " << PEER.rows() << " x " << PEER.cols() << endl;
     cout << "PEEL: " << PEEL.rows() << " x " << PEEL.cols() << endl;
     cout << "PBal: " << PBal.rows() << " x " << PBal.cols() << endl;
@@ -406,30 +544,77 @@ void Controller::update(const Eigen::Vector3d& _targetPosition) {
   const vector<double> lb(30, -10);
   const vector<double> ub(30, 10);
 
-  //nlopt::opt opt(nlopt::LN_COBYLA, 30);
-  nlopt::opt opt(nlopt::LD_SLSQP, 30);
-  double minf;
-  opt.set_min_objective(optFunc, &optParams);
-  //opt.add_inequality_mconstraint(constraintFunc, &constraintParams[0], constraintTol);
-  //opt.add_inequality_mconstraint(constraintFunc, &constraintParams[1], constraintTol);
-  opt.add_equality_mconstraint(constraintFunc, &constraintParams[1], constraintTol);
-  //opt.set_lower_bounds(lb);
-  //opt.set_upper_bounds(ub);
-  opt.set_xtol_rel(1e-3);
+  mProblem.P = P;
+  mProblem.b = b;
+  mProblem.A = P_;
+  mProblem.c = b_;
+  mProblem.x0 = ddq_lambda;
+  mProblem.M = M;
+  mProblem.h = h;
+  mProblem.J = J;
+
   int maxtimeSet = 0;
-  //opt.set_maxtime(0.01); int maxtimeSet = 1;
-  vector<double> ddq_lambda_vec(30);
-  Eigen::VectorXd::Map(&ddq_lambda_vec[0], ddq_lambda.size()) = ddq_lambda;
-  opt.optimize(ddq_lambda_vec, minf);
-  Eigen::Matrix<double, 30, 1> ddq_lambda(ddq_lambda_vec.data());
-  if(mSteps < 0) {
+  bool solved = true, solvedDirectly = false;
+  if (mSolver == CLOSED_FORM) {
+    // Stack the tasks in the solve's precision from their blocks, so only
+    // the dense rows and the diagonal weights are converted
+    Eigen::Matrix<double, 9, 30> dense;
+    dense << PEER, PEEL, PBal;
+    Eigen::Matrix<double, 9, 1> denseB;
+    denseB << bEER, bEEL, bBal;
+    Eigen::Matrix<double, 30, 3> diagonals, diagonalB;
+    diagonals << wMatPose.diagonal(), wMatSpeedReg.diagonal(), wMatReg.diagonal();
+    diagonalB << bPose, bSpeedReg, bReg;
+    stackClosedFormTasks(dense, denseB, diagonals, diagonalB, &mScalarP, &mScalarB);
+    solvedDirectly = solveClosedFormQP(mScalarP, mScalarB, P_, b_, ddq_lambda, mDamping, &ddq_lambda);
+  }
+  else if (mSolver == ACTIVE_SET) {
+    computeInequalities(mProblem, &mProblem.C, &mProblem.d);
+    solvedDirectly = mBoundedQP.solve(P, b, P_, b_, mProblem.C, mProblem.d, ddq_lambda, mDamping, &ddq_lambda);
+  }
+  if (!solvedDirectly) {
+    //nlopt::opt opt(nlopt::LN_COBYLA, 30);
+    nlopt::opt opt(nlopt::LD_SLSQP, 30);
+    double minf;
+    opt.set_min_objective(optFunc, &optParams);
+    //opt.add_inequality_mconstraint(constraintFunc, &constraintParams[0], constraintTol);
+    //opt.add_inequality_mconstraint(constraintFunc, &constraintParams[1], constraintTol);
+    opt.add_equality_mconstraint(constraintFunc, &constraintParams[1], constraintTol);
+    //opt.set_lower_bounds(lb);
+    //opt.set_upper_bounds(ub);
+    opt.set_xtol_rel(1e-3);
+    // With a fallback the solve must not run far past its budget
+    if (mFallbackBudget > 0.0) { opt.set_maxtime(mFallbackBudget); maxtimeSet = 1; }
+    vector<double> ddq_lambda_vec(30);
+    Eigen::VectorXd::Map(&ddq_lambda_vec[0], ddq_lambda.size()) = ddq_lambda;
+    try {
+      nlopt::result result = opt.optimize(ddq_lambda_vec, minf);
+      solved = (result != nlopt::MAXTIME_REACHED);
+    }
+    catch (const std::exception& e) {
+      if (mVerbose && mFallbackBudget <= 0.0) cout << "[controller] SLSQP failed: " << e.what() << endl;
+      solved = false;
+    }
+    // Keep the solution in the member so the next tick warm starts from it
+    Eigen::Matrix<double, 30, 1> solution(ddq_lambda_vec.data());
+    if (solution.allFinite()) ddq_lambda = solution;
+    else solved = false;
+  }
+  if(mVerbose && mSteps < 0) {
     cout << "ddq_lambda: " << endl; for(int i=0; i<30; i++) {cout << ddq_lambda(i) << ", ";} cout << endl;
-    cout << "ddq_lambda_vec: " << endl; for(int i=0; i<30; i++) {cout << ddq_lambda_vec[i] << ", ";} cout << endl;
   }
 
+  // Task losses
+  mTaskLosses << pow((PEEL*ddq_lambda-bEEL).norm(), 2),
+                 pow((PEER*ddq_lambda-bEER).norm(), 2),
+                 pow((PBal*ddq_lambda-bBal).norm(), 2),
+                 pow((PPose*ddq_lambda-bPose).norm(), 2),
+                 pow((PSpeedReg*ddq_lambda-bSpeedReg).norm(), 2),
+                 pow((PReg*ddq_lambda-bReg).norm(), 2);
+
   // Torques
-  mForces << (M.block<19, 25>(6,0)*ddq_lambda.head(25) + h.tail(19) - (J.block<5, 19>(0,6).transpose())*ddq_lambda.tail(5));
-  if(mSteps%(maxtimeSet==1?30:30) == 0) {
+  mForces = computeForces(mProblem, ddq_lambda);
+  if(mVerbose && mSteps%(maxtimeSet==1?30:30) == 0) {
     cout << "mForces: " << mForces(0);
     for(int i=1; i<3; i++){ 
       cout << ", " << mForces(i); 
@@ -455,16 +640,345 @@ void Controller::update(const Eigen::Vector3d& _targetPosition) {
     cout << "J6*lambda: " << (J.block<5,1>(0,6).transpose()*ddq_lambda.tail(5)) << endl;
     cout << "J7*lambda: " << (J.block<5,1>(0,7).transpose()*ddq_lambda.tail(5)) << endl;
     // Print the objective function components 
-    cout << "EEL loss: " << pow((PEEL*ddq_lambda-bEEL).norm(), 2) << endl;
-    cout << "EER loss: " << pow((PEER*ddq_lambda-bEER).norm(), 2) << endl;
-    cout << "Bal loss: " << pow((PBal*ddq_lambda-bBal).norm(), 2) << endl;
-    cout << "Pose loss: " << pow((PPose*ddq_lambda-bPose).norm(), 2) << endl;
-    cout << "Speed Reg loss: " << pow((PSpeedReg*ddq_lambda-bSpeedReg).norm(), 2) << endl;
-    cout << "Reg loss: " << pow((PReg*ddq_lambda-bReg).norm(), 2) << endl;
+    cout << "EEL loss: " << mTaskLosses(0) << endl;
+    cout << "EER loss: " << mTaskLosses(1) << endl;
+    cout << "Bal loss: " << mTaskLosses(2) << endl;
+    cout << "Pose loss: " << mTaskLosses(3) << endl;
+    cout << "Speed Reg loss: " << mTaskLosses(4) << endl;
+    cout << "Reg loss: " << mTaskLosses(5) << endl;
     cout << "Equality: "; for(int i=0; i<6; i++) {cout << (P_*ddq_lambda-b_)(i) << ", ";} cout << endl << endl << endl;
   }
-  const vector<size_t > index{6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24};
-  mRobot->setForces(index, mForces);
+  applyForces();
+  return solved;
+}
+
+//=========================================================================
+void Controller::updateBalanceOnly() {
+  Eigen::VectorXd q = mRobot->getPositions();
+  Eigen::VectorXd dq = dqFilt->average;
+  Eigen::Matrix<double, 4, 4> baseTf = mRobot->getBodyNode(0)->getTransform().matrix();
+  Eigen::Vector3d xyz0 = q.segment(3,3);
+  Eigen::Vector3d dxyz0 = baseTf.block<3,3>(0,0)*dq.segment(3,3);
+
+  // Heading, as in the whole-body controller
+  double psi =  atan2(baseTf(0,0), -baseTf(1,0));
+  Eigen::Matrix3d Rot0 = Eigen::AngleAxisd(psi, Eigen::Vector3d::UnitZ()).toRotationMatrix().transpose();
+  double dpsi = (baseTf.block<3,3>(0,0)*dq.head(3))(2);
+
+  // Body COM without the wheels relative to the wheel axis, and forward speed
+  Eigen::Vector3d bodyCOM = ( \
+    mRobot->getMass()*mRobot->getCOM() - mLWheel->getMass()*mLWheel->getCOM() - mRWheel->getMass()*mRWheel->getCOM()) \
+    /(mRobot->getMass() - mLWheel->getMass() - mRWheel->getMass());
+  Eigen::Vector3d bodyCOMLinearVelocity = ( \
+    mRobot->getMass()*mRobot->getCOMLinearVelocity() - mLWheel->getMass()*mLWheel->getCOMLinearVelocity() - mRWheel->getMass()*mRWheel->getCOMLinearVelocity()) \
+    /(mRobot->getMass() - mLWheel->getMass() - mRWheel->getMass());
+  double xCOM = (Rot0*(bodyCOM - xyz0))(0);
+  double dxCOM = (Rot0*(bodyCOMLinearVelocity - dxyz0))(0);
+  double speed = (Rot0*dxyz0)(0);
+
+  // Wheeled inverted pendulum: drive the wheels under the COM, lean back
+  // against the forward speed, and damp the yaw rate with the difference
+  double xCOMref = mCOMTarget(0) - mBalanceSpeedGain*speed;
+  double tau = mBalanceKp*(xCOM - xCOMref) + mBalanceKd*dxCOM;
+  mForces(0) = 0.5*tau + mBalanceYawKd*dpsi;
+  mForces(1) = 0.5*tau - mBalanceYawKd*dpsi;
+
+  // The upper body holds its posture with gravity compensation
+  Eigen::VectorXd g = mRobot->getGravityForces();
+  mForces.tail(17) = g.tail(17) + mHoldKp*(mHoldQ.tail(17) - q.tail(17)) - mHoldKv*dq.tail(17);
+
+  applyForces();
+}
+
+//=========================================================================
+void Controller::applyForces() {
+  const Eigen::Matrix<double, 19, 1> clamped = mForces.cwiseMax(-mTorqueLimits).cwiseMin(mTorqueLimits);
+  if (clamped != mForces) ++mNumClampedTicks;
+  mForces = clamped;
+  mRobot->setForces(actuatedDofs, mForces);
+}
+
+//=========================================================================
+void Controller::setMode(Mode _mode) {
+  if (_mode == BALANCE_ONLY && mMode != BALANCE_ONLY) mHoldQ = mRobot->getPositions();
+  mMode = _mode;
+  mTicksSinceProbe = mGoodProbes = 0;
+  mSkipsSinceSolve = mLazyMaxSkips;
+}
+
+//=========================================================================
+void Controller::setFallback(double _budget, std::size_t _probeEvery, std::size_t _probesToRecover) {
+  mFallbackBudget = _budget;
+  mFallbackProbeEvery = _probeEvery;
+  mFallbackProbesToRecover = _probesToRecover;
+}
+
+//=========================================================================
+void Controller::setLazySolve(double _qTolerance, double _dqTolerance, double _targetTolerance,
+                              std::size_t _maxSkips) {
+  mLazyQTolerance = _qTolerance;
+  mLazyDqTolerance = _dqTolerance;
+  mLazyTargetTolerance = _targetTolerance;
+  mLazyMaxSkips = _maxSkips;
+  mSkipsSinceSolve = _maxSkips;
+}
+
+//=========================================================================
+void Controller::setVerbose(bool _verbose) {
+  mVerbose = _verbose;
+}
+
+//=========================================================================
+Eigen::MatrixXd Controller::computeConstraintJacobian(const Eigen::Matrix<double, 4, 4>& _baseTf) {
+  // Constraints:
+  //  0. dZ0 = 0                                               
+  //                                                              => dq_orig(4)*cos(qBody1) + dq_orig(5)*sin(qBody1) = 0
+  //  1. da3 + R/L*(dthL - dthR) = 0                           
+  //                                                              => dq_orig(1)*cos(qBody1) + dq_orig(2)*sin(qBody1) + R/L*(dq_orig(6) - dq_orig(7)) = 0 
+  //  2. da1*cos(psii) + da2*sin(psii) = 0                     
+  //                                                              => dq_orig(1)*sin(qBody1) - dq_orig(2)*cos(qBody1) = 0
+  //  3. dX0*sin(psii) - dY0*cos(psii) = 0                     
+  //                                                              => dq_orig(3) = 0
+  //  4. dX0*cos(psii) + dY0*sin(psii) - R/2*(dthL + dthR) = 0 
+  //                                                              => dq_orig(4)*sin(qBody1) - dq_orig(5)*cos(qBody1) - R/2*(dq_orig(6) + dq_orig(7) - 2*dq_orig(0)) = 0
+  double R = 0.265, L = 0.68;
+  double psi =  atan2(_baseTf(0,0), -_baseTf(1,0));
+  double qBody1; 
+  qBody1 = atan2(_baseTf(0,1)*cos(psi) + _baseTf(1,1)*sin(psi), _baseTf(2,1));
+  Eigen::MatrixXd J = Eigen::MatrixXd::Zero(5, 25);
+  J(0,4) = cos(qBody1); J(0,5) = sin(qBody1);
+  J(1,1) = cos(qBody1); J(1,2) = sin(qBody1); J(1,6) = R/L; J(1,7) = -R/L;
+  J(2,1) = sin(qBody1); J(2,2) = -cos(qBody1); 
+  J(3,3) = 1;
+  J(4,0) = R; J(4,4) = sin(qBody1); J(4,5) = -cos(qBody1); J(4,6) = -R/2; J(4,7) = -R/2;
+  return J;
+}
+
+//=========================================================================
+void Controller::setSolver(SolverType _solver, double _damping) {
+  mSolver = _solver;
+  mDamping = _damping;
+}
+
+//=========================================================================
+Eigen::Matrix<double, 19, 1> Controller::computeForces(const Problem& _problem,
+                                                       const Eigen::Matrix<double, 30, 1>& _ddq_lambda) {
+  return _problem.M.block<19, 25>(6,0)*_ddq_lambda.head(25) + _problem.h.tail(19)
+    - (_problem.J.block<5, 19>(0,6).transpose())*_ddq_lambda.tail(5);
+}
+
+//=========================================================================
+void Controller::setLimits(const Eigen::Matrix<double, 19, 1>& _torqueLimits,
+                           double _accelerationLimit, double _frictionCoefficient) {
+  mTorqueLimits = _torqueLimits;
+  mAccelerationLimit = _accelerationLimit;
+  mFrictionCoefficient = _frictionCoefficient;
+  mBoundedQP.reset();
+}
+
+//=========================================================================
+void Controller::computeInequalities(const Problem& _problem, Eigen::MatrixXd* _C,
+                                     Eigen::VectorXd* _d) const {
+  const bool limitAccelerations = std::isfinite(mAccelerationLimit);
+  const bool limitFriction = mFrictionCoefficient > 0.0;
+  int rows = (limitAccelerations ? 50 : 0) + (limitFriction ? 4 : 0);
+  for (int i = 0; i < 19; ++i) if (std::isfinite(mTorqueLimits(i))) rows += 2;
+  _C->setZero(rows, 30);
+  _d->resize(rows);
+
+  // Torques tau = T x + h.tail(19), as in computeForces()
+  int row = 0;
+  for (int i = 0; i < 19; ++i) {
+    if (!std::isfinite(mTorqueLimits(i))) continue;
+    Eigen::Matrix<double, 1, 30> T;
+    T << _problem.M.block<1, 25>(6 + i, 0), -_problem.J.block<5, 1>(0, 6 + i).transpose();
+    _C->row(row) = T;
+    (*_d)(row++) = -mTorqueLimits(i) - _problem.h(6 + i);
+    _C->row(row) = -T;
+    (*_d)(row++) = -mTorqueLimits(i) + _problem.h(6 + i);
+  }
+  if (limitAccelerations) {
+    for (int i = 0; i < 25; ++i) {
+      (*_C)(row, i) = 1.0;
+      (*_d)(row++) = -mAccelerationLimit;
+      (*_C)(row, i) = -1.0;
+      (*_d)(row++) = -mAccelerationLimit;
+    }
+  }
+  // Friction pyramid on the lateral (3) and rolling (4) constraint forces,
+  // with the weight of the robot as the normal load
+  if (limitFriction) {
+    const double maxForce = mFrictionCoefficient*mRobot->getMass()*9.81;
+    for (int k = 3; k < 5; ++k) {
+      (*_C)(row, 25 + k) = 1.0;
+      (*_d)(row++) = -maxForce;
+      (*_C)(row, 25 + k) = -1.0;
+      (*_d)(row++) = -maxForce;
+    }
+  }
+}
+
+//=========================================================================
+void Controller::setCOMGains(double _kp, double _kv) {
+  mKpxCOM = _kp;
+  mKvxCOM = _kv;
+}
+
+//=========================================================================
+void Controller::copySettings(const Controller& _other) {
+  mKp = _other.mKp;
+  mKv = _other.mKv;
+  mKpxCOM = _other.mKpxCOM;
+  mKvxCOM = _other.mKvxCOM;
+  mSolver = _other.mSolver;
+  mDamping = _other.mDamping;
+  mFallbackBudget = _other.mFallbackBudget;
+  mFallbackProbeEvery = _other.mFallbackProbeEvery;
+  mFallbackProbesToRecover = _other.mFallbackProbesToRecover;
+  mBalanceKp = _other.mBalanceKp;
+  mBalanceKd = _other.mBalanceKd;
+  mBalanceSpeedGain = _other.mBalanceSpeedGain;
+  mBalanceYawKd = _other.mBalanceYawKd;
+  mHoldKp = _other.mHoldKp;
+  mHoldKv = _other.mHoldKv;
+  mLazyQTolerance = _other.mLazyQTolerance;
+  mLazyDqTolerance = _other.mLazyDqTolerance;
+  mLazyTargetTolerance = _other.mLazyTargetTolerance;
+  mLazyMaxSkips = _other.mLazyMaxSkips;
+  mVerbose = _other.mVerbose;
+  mTorqueLimits = _other.mTorqueLimits;
+  mAccelerationLimit = _other.mAccelerationLimit;
+  mFrictionCoefficient = _other.mFrictionCoefficient;
+}
+
+//=========================================================================
+void Controller::setCOMTarget(const Eigen::Vector3d& _comTarget) {
+  mCOMTarget = _comTarget;
+}
+
+//=========================================================================
+void Controller::saveState(std::vector<double>& _buffer) const {
+  _buffer.push_back(static_cast<double>(mSteps));
+  _buffer.push_back(zCOMInit);
+  _buffer.insert(_buffer.end(), qInit.data(), qInit.data() + qInit.size());
+  _buffer.insert(_buffer.end(), mCOMTarget.data(), mCOMTarget.data() + mCOMTarget.size());
+  _buffer.insert(_buffer.end(), ddq_lambda.data(), ddq_lambda.data() + ddq_lambda.size());
+  _buffer.insert(_buffer.end(), mForces.data(), mForces.data() + mForces.size());
+  _buffer.insert(_buffer.end(), mTaskLosses.data(), mTaskLosses.data() + mTaskLosses.size());
+
+  // Velocity filter, oldest sample first
+  _buffer.push_back(static_cast<double>(dqFilt->size));
+  _buffer.insert(_buffer.end(), dqFilt->total.data(), dqFilt->total.data() + dqFilt->total.size());
+  for (int i = 0; i < dqFilt->size; ++i)
+    _buffer.insert(_buffer.end(), dqFilt->sample(i).data(), dqFilt->sample(i).data() + dqFilt->dim);
+
+  // Mode and fallback progress
+  _buffer.push_back(static_cast<double>(mMode));
+  _buffer.insert(_buffer.end(), mHoldQ.data(), mHoldQ.data() + mHoldQ.size());
+  _buffer.push_back(static_cast<double>(mTicksSinceProbe));
+  _buffer.push_back(static_cast<double>(mGoodProbes));
+
+  // Active set the bounded QP starts from
+  const std::vector<int>& active = mBoundedQP.getActiveSet();
+  _buffer.push_back(static_cast<double>(active.size()));
+  _buffer.insert(_buffer.end(), active.begin(), active.end());
+}
+
+//=========================================================================
+const double* Controller::loadState(const double* _in) {
+  mSteps = static_cast<size_t>(*_in++);
+  zCOMInit = *_in++;
+  qInit = Eigen::Map<const Eigen::Matrix<double, 25, 1> >(_in); _in += qInit.size();
+  mCOMTarget = Eigen::Map<const Eigen::Vector3d>(_in); _in += mCOMTarget.size();
+  ddq_lambda = Eigen::Map<const Eigen::Matrix<double, 30, 1> >(_in); _in += ddq_lambda.size();
+  mForces = Eigen::Map<const Eigen::Matrix<double, 19, 1> >(_in); _in += mForces.size();
+  mTaskLosses = Eigen::Map<const Eigen::Matrix<double, 6, 1> >(_in); _in += mTaskLosses.size();
+
+  const int n = static_cast<int>(*_in++);
+  const int dim = dqFilt->dim;
+  Eigen::Map<const Eigen::VectorXd> total(_in, dim); _in += dim;
+  dqFilt->assign(_in, n, total); _in += n*dim;
+
+  mMode = static_cast<Mode>(static_cast<int>(*_in++));
+  mHoldQ = Eigen::Map<const Eigen::Matrix<double, 25, 1> >(_in); _in += mHoldQ.size();
+  mTicksSinceProbe = static_cast<std::size_t>(*_in++);
+  mGoodProbes = static_cast<std::size_t>(*_in++);
+
+  std::vector<int> active(static_cast<std::size_t>(*_in++));
+  for (std::size_t i = 0; i < active.size(); ++i) active[i] = static_cast<int>(*_in++);
+  mBoundedQP.setActiveSet(active);
+
+  // The lazy solve references belong to another trajectory
+  mSkipsSinceSolve = mLazyMaxSkips;
+  return _in;
+}
+
+//=========================================================================
+void Controller::computeDriftTerms(const Eigen::VectorXd& _dq, Eigen::Vector3d* _dJEELdq,
+                                   Eigen::Vector3d* _dJEERdq, Eigen::Vector3d* _dJCOMdq) {
+  const std::size_t numBodies = mRobot->getNumBodyNodes();
+  mDriftAngular.resize(numBodies);
+  mDriftLinear.resize(numBodies);
+  mDriftOmega.resize(numBodies);
+
+  // Forward recursion, parents first. Spatial quantities are taken at the
+  // world origin: a column of the joint of body b is s = (w, v) with w and u
+  // its angular and linear parts at the origin o of b and v = u + o x w, and
+  // as it is fixed in b it changes as V_b x s with V_b = (om, vo - om x o).
+  // A = (angular, linear) sums (V_b x s) dq over the kept columns of the
+  // ancestors of a body, W sums w dq, and a point x moving with dx on the
+  // body then has the drift A.linear + A.angular x x + W x dx.
+  for (std::size_t b = 0; b < numBodies; ++b) {
+    dart::dynamics::BodyNode* body = mRobot->getBodyNode(b);
+    dart::dynamics::BodyNode* parent = body->getParentBodyNode();
+    Eigen::Vector3d& angular = mDriftAngular[b];
+    Eigen::Vector3d& linear = mDriftLinear[b];
+    Eigen::Vector3d& omega = mDriftOmega[b];
+    if (parent == nullptr) {
+      angular.setZero(); linear.setZero(); omega.setZero();
+    } else {
+      const std::size_t p = parent->getIndexInSkeleton();
+      angular = mDriftAngular[p]; linear = mDriftLinear[p]; omega = mDriftOmega[p];
+    }
+
+    const dart::dynamics::Joint* joint = body->getParentJoint();
+    const Eigen::Isometry3d& tf = body->getTransform();
+    const Eigen::Vector3d o = tf.translation();
+    const Eigen::Vector3d om = body->getAngularVelocity();
+    const Eigen::Vector3d vb = body->getLinearVelocity() - om.cross(o);
+    const dart::math::Jacobian S = joint->getRelativeJacobian();
+    for (std::size_t k = 0; k < joint->getNumDofs(); ++k) {
+      // The task Jacobians drop the base dofs but the first and the wheels
+      const std::size_t i = joint->getIndexInSkeleton(k);
+      if (i != 0 && i < 8) continue;
+
+      const Eigen::Vector3d w = tf.linear()*S.col(k).head<3>();
+      const Eigen::Vector3d v = tf.linear()*S.col(k).tail<3>() + o.cross(w);
+      angular += _dq(i)*om.cross(w);
+      linear += _dq(i)*(om.cross(v) + vb.cross(w));
+      omega += _dq(i)*w;
+    }
+  }
+
+  // The end effectors are points of their bodies, the COM sums the bodies'
+  // COMs. The task Jacobians only have columns of ancestors, as above.
+  const std::size_t l = mLeftEndEffector->getIndexInSkeleton();
+  const std::size_t r = mRightEndEffector->getIndexInSkeleton();
+  *_dJEELdq = mDriftLinear[l]
+              + mDriftAngular[l].cross(mLeftEndEffector->getTransform().translation())
+              + mDriftOmega[l].cross(mLeftEndEffector->getLinearVelocity());
+  *_dJEERdq = mDriftLinear[r]
+              + mDriftAngular[r].cross(mRightEndEffector->getTransform().translation())
+              + mDriftOmega[r].cross(mRightEndEffector->getLinearVelocity());
+  _dJCOMdq->setZero();
+  for (std::size_t b = 0; b < numBodies; ++b) {
+    dart::dynamics::BodyNode* body = mRobot->getBodyNode(b);
+    *_dJCOMdq += body->getMass()*(mDriftLinear[b] + mDriftAngular[b].cross(body->getCOM())
+                                  + mDriftOmega[b].cross(body->getCOMLinearVelocity()));
+  }
+
+  // The COM task is on the body without the wheels, see JCOM_world
+  *_dJCOMdq /= mRobot->getMass() - mLWheel->getMass() - mRWheel->getMass();
 }
 
 //=========================================================================
@@ -33,41 +33,126 @@
 #define EXAMPLES_OPERATIONALSPACECONTROL_CONTROLLER_HPP_
 
 #include <Eigen/Eigen>
+#include <algorithm>
 #include <string>
+#include <vector>
 #include <dart/dart.hpp>
-#include <boost/circular_buffer.hpp>
 
+#include "ActiveSetQP.hpp"
+#include "Arena.hpp"
+#include "ClosedFormQP.hpp"
+#include "KrangKinematics.hpp"
+
+/// \brief Moving average of the last n samples of dimension dim. The samples
+/// live in one contiguous dim x n ring, allocated by the filter or, to keep
+/// the state of many controllers together, handed in by the caller.
 class filter {
   public:
-    filter(const int dim, const int n)
+    /// \brief _storage, if given, holds dim*n doubles and must outlive the
+    /// filter
+    filter(const int dim, const int n, double* _storage = nullptr)
+      : ring(_storage ? _storage : new double[dim*n]), ownsRing(_storage == nullptr),
+        dim(dim), capacity(n), size(0), next(0)
     {
-      samples.set_capacity(n);
       total = Eigen::VectorXd::Zero(dim,1);
+      average = total;
+    }
+    ~filter()
+    {
+      if (ownsRing) delete[] ring;
     }
-    void AddSample(Eigen::VectorXd v)
+    filter(const filter&) = delete;
+    filter& operator=(const filter&) = delete;
+
+    void AddSample(const Eigen::VectorXd& v)
     {
-      if(samples.full()) 
-      {
-        total -= samples.front();
-      }
-      samples.push_back(v);
+      Eigen::Map<Eigen::VectorXd> slot(ring + next*dim, dim);
+      if (size == capacity) total -= slot;
+      else ++size;
+      slot = v;
       total += v;
-      average = total/samples.size();
+      next = (next + 1)%capacity;
+      average = total/size;
+    }
+
+    /// \brief The _i-th oldest sample
+    Eigen::Map<const Eigen::VectorXd> sample(int _i) const
+    {
+      return Eigen::Map<const Eigen::VectorXd>(ring + ((next - size + _i + capacity)%capacity)*dim, dim);
     }
-  
-    boost::circular_buffer<Eigen::VectorXd> samples;
+
+    /// \brief Replace the samples by the _n ones at _samples, oldest first,
+    /// whose sum is _total
+    void assign(const double* _samples, int _n, const Eigen::VectorXd& _total)
+    {
+      size = std::min(_n, capacity);
+      std::copy(_samples + (_n - size)*dim, _samples + _n*dim, ring);
+      next = size%capacity;
+      total = _total;
+      if (size > 0) average = total/size;
+    }
+
+    double* ring;
+    bool ownsRing;
+    int dim;
+    int capacity;
+    int size;
+    /// \brief Slot of the next sample
+    int next;
     Eigen::VectorXd total;
     Eigen::VectorXd average;
-    
 };
 
 /// \brief Operational space controller for 6-dof manipulator
 class Controller {
 public:
-  /// \brief Constructor
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /// \brief How update() solves the QP
+  enum SolverType {
+    /// \brief nlopt SLSQP from the previous solution
+    SLSQP,
+    /// \brief Closed-form KKT solve in ControllerScalar precision, damped
+    /// toward the previous solution. Falls back to SLSQP if it fails.
+    CLOSED_FORM,
+    /// \brief Active-set solve of the QP bounded by the limits of
+    /// setLimits(), damped like CLOSED_FORM and warm-started from the
+    /// previous active set. Falls back to SLSQP if it fails.
+    ACTIVE_SET
+  };
+
+  /// \brief What update() controls
+  enum Mode {
+    /// \brief Whole-body QP over all 25 dofs
+    WHOLE_BODY,
+    /// \brief Reduced wheeled inverted pendulum: the wheels balance the
+    /// body COM over the wheel axis while the upper body holds its posture.
+    /// No mass matrix, Jacobians or QP.
+    BALANCE_ONLY
+  };
+
+  /// \brief The QP of the last update: tasks _P x = _b, constraint A x = c,
+  /// limits C x >= d (ACTIVE_SET only), previous solution x0, and what maps
+  /// a solution to the torques
+  struct Problem {
+    Eigen::MatrixXd P;
+    Eigen::VectorXd b;
+    Eigen::Matrix<double, 6, 30> A;
+    Eigen::Matrix<double, 6, 1> c;
+    Eigen::MatrixXd C;
+    Eigen::VectorXd d;
+    Eigen::Matrix<double, 30, 1> x0;
+    Eigen::MatrixXd M;
+    Eigen::VectorXd h;
+    Eigen::MatrixXd J;
+  };
+
+  /// \brief Constructor. With an _arena, the velocity filter ring is
+  /// allocated from it and must not outlive it.
   Controller( dart::dynamics::SkeletonPtr _robot,
               dart::dynamics::BodyNode* _LeftendEffector,
-              dart::dynamics::BodyNode* _RightendEffector);
+              dart::dynamics::BodyNode* _RightendEffector,
+              Arena* _arena = nullptr);
 
   /// \brief Destructor
   virtual ~Controller();
@@ -75,6 +160,105 @@ public:
   /// \brief
   void update(const Eigen::Vector3d& _targetPosition);
 
+  /// \brief Track a moving end effector target in frame 0, with its velocity
+  /// and acceleration fed forward to the task references
+  void update(const Eigen::Vector3d& _targetPosition,
+              const Eigen::Vector3d& _targetVelocity,
+              const Eigen::Vector3d& _targetAcceleration);
+
+  /// \brief Switch between the whole-body and the balance-only controller.
+  /// Entering BALANCE_ONLY holds the current upper body posture.
+  void setMode(Mode _mode);
+
+  /// \brief Fall back to BALANCE_ONLY when a whole-body update fails or takes
+  /// longer than _budget s (SLSQP is also stopped at _budget). While falling
+  /// back, the whole-body update is probed every _probeEvery ticks, and after
+  /// _probesToRecover good probes in a row it takes over again. _budget <= 0
+  /// (the default) disables the automatic switch.
+  void setFallback(double _budget, std::size_t _probeEvery = 100,
+                   std::size_t _probesToRecover = 3);
+
+  /// \brief Set the body COM target in frame 0. Only the x (forward) and z
+  /// (height) components are tracked by the balance task.
+  void setCOMTarget(const Eigen::Vector3d& _comTarget);
+
+  /// \brief Set the stiffness and damping of the whole-body balance task on
+  /// the body COM, 750 and 250 by default
+  void setCOMGains(double _kp, double _kv);
+
+  /// \brief Print the setup on the first update, the periodic debug dumps
+  /// and the fallback messages to std::cout (the default), or nothing at all.
+  /// Benchmarks turn it off so that formatting the dumps stays out of their
+  /// timings.
+  void setVerbose(bool _verbose);
+
+  /// \brief Take over the settings of _other: solver, gains, limits, lazy
+  /// solve, fallback and verbosity. The state saved by saveState() is left
+  /// alone.
+  void copySettings(const Controller& _other);
+
+  /// \brief Limits enforced by the ACTIVE_SET solver: joint torques of dofs
+  /// 6 to 24 within +-_torqueLimits, accelerations of the 25 dofs within
+  /// +-_accelerationLimit, and, if _frictionCoefficient > 0, the lateral and
+  /// rolling constraint forces of the wheels within _frictionCoefficient
+  /// times the robot's weight. Infinite entries are unlimited. The torques
+  /// of every mode and solver are clamped to _torqueLimits before they are
+  /// applied. Defaults to the URDF effort limits, 10 and no friction limit.
+  void setLimits(const Eigen::Matrix<double, 19, 1>& _torqueLimits,
+                 double _accelerationLimit, double _frictionCoefficient = 0.0);
+
+  /// \brief Inequalities _C x >= _d of the limits for the QP _problem
+  void computeInequalities(const Problem& _problem, Eigen::MatrixXd* _C,
+                           Eigen::VectorXd* _d) const;
+
+  /// \brief Select the QP solver, SLSQP by default
+  void setSolver(SolverType _solver, double _damping = 1e-4);
+
+  /// \brief Reuse the last solution while q, the filtered dq and the targets
+  /// stay within the given max-norm distances of where it was solved: only
+  /// the Coriolis, gravity and constraint terms of the torques are refreshed.
+  /// A full solve is forced after _maxSkips reuses in a row. _maxSkips = 0
+  /// (the default) solves every tick.
+  void setLazySolve(double _qTolerance, double _dqTolerance, double _targetTolerance,
+                    std::size_t _maxSkips);
+
+  /// \brief Constraint Jacobian of the wheels rolling without slipping
+  static Eigen::MatrixXd computeConstraintJacobian(const Eigen::Matrix<double, 4, 4>& _baseTf);
+
+  /// \brief Joint torques of dofs 6 to 24 for a solution _ddq_lambda of
+  /// _problem
+  static Eigen::Matrix<double, 19, 1> computeForces(const Problem& _problem,
+                                                    const Eigen::Matrix<double, 30, 1>& _ddq_lambda);
+
+  /// \brief Append the controller's internal state (step counter, initial
+  /// pose, targets, solver warm starts, velocity filter, mode) to _buffer
+  void saveState(std::vector<double>& _buffer) const;
+
+  /// \brief Restore a state written by saveState() starting at _in. Returns
+  /// the position right after it.
+  const double* loadState(const double* _in);
+
+  /// \brief Whole-body QP update, applies the torques. Returns false if the
+  /// solve failed.
+  bool updateWholeBody(const Eigen::Vector3d& _targetPosition,
+                       const Eigen::Vector3d& _targetVelocity,
+                       const Eigen::Vector3d& _targetAcceleration);
+
+  /// \brief Balance-only update, applies the torques
+  void updateBalanceOnly();
+
+  /// \brief Clamp mForces to the torque limits and apply them
+  void applyForces();
+
+  /// \brief Drift terms dJ*_dq in the world frame of the left and right end
+  /// effector tasks and of the body COM task, for the columns the task
+  /// Jacobians keep (dof 0 and 8 to 24). dJ is taken at the robot's current
+  /// velocities, as getLinearJacobianDeriv() does, but no Jacobian derivative
+  /// is formed: a forward recursion over the bodies accumulates the column
+  /// drifts from the body velocities, and each task reads its point off it.
+  void computeDriftTerms(const Eigen::VectorXd& _dq, Eigen::Vector3d* _dJEELdq,
+                         Eigen::Vector3d* _dJEERdq, Eigen::Vector3d* _dJCOMdq);
+
   /// \brief Get robot
   dart::dynamics::SkeletonPtr getRobot() const;
 
@@ -106,15 +290,108 @@ public:
   /// \brief Derivative gain for the virtual spring forces at the end effector
   Eigen::Matrix3d mKv;
 
+  /// \brief Gains of the whole-body balance task on the body COM
+  double mKpxCOM;
+  double mKvxCOM;
+
   size_t mSteps;
 
   Eigen::Matrix<double, 30, 1> ddq_lambda;
 
+  SolverType mSolver;
+
+  /// \brief Weight of the damping toward the previous solution of the
+  /// closed-form solver
+  double mDamping;
+
+  /// \brief The last QP, overwritten in place every full solve
+  Problem mProblem;
+
+  /// \brief Tasks of the closed-form solve, stacked in ControllerScalar
+  Eigen::Matrix<ControllerScalar, Eigen::Dynamic, 30> mScalarP;
+  Eigen::Matrix<ControllerScalar, Eigen::Dynamic, 1> mScalarB;
+
+  /// \brief Limits, see setLimits()
+  Eigen::Matrix<double, 19, 1> mTorqueLimits;
+  double mAccelerationLimit;
+  double mFrictionCoefficient;
+
+  /// \brief Solver of the bounded QP, holding the active set across ticks
+  ActiveSetQP mBoundedQP;
+
+  /// \brief Ticks whose torques were clamped to the limits
+  std::size_t mNumClampedTicks;
+
+  Mode mMode;
+
+  /// \brief Automatic fallback settings, see setFallback()
+  double mFallbackBudget;
+  std::size_t mFallbackProbeEvery;
+  std::size_t mFallbackProbesToRecover;
+
+  /// \brief Ticks since the last probe and good probes in a row
+  std::size_t mTicksSinceProbe;
+  std::size_t mGoodProbes;
+
+  /// \brief Balance-only gains: wheel torque per m of COM offset and per m/s
+  /// of COM velocity, COM offset per m/s of forward speed, and differential
+  /// wheel torque per rad/s of yaw rate
+  double mBalanceKp;
+  double mBalanceKd;
+  double mBalanceSpeedGain;
+  double mBalanceYawKd;
+
+  /// \brief Upper body posture held in balance-only mode, with its gains
+  Eigen::Matrix<double, 25, 1> mHoldQ;
+  double mHoldKp;
+  double mHoldKv;
+
+  /// \brief Whether update() prints anything, see setVerbose()
+  bool mVerbose;
+
+  /// \brief Lazy solve thresholds, see setLazySolve()
+  double mLazyQTolerance;
+  double mLazyDqTolerance;
+  double mLazyTargetTolerance;
+  std::size_t mLazyMaxSkips;
+
+  /// \brief Ticks since the last full solve
+  std::size_t mSkipsSinceSolve;
+
+  /// \brief Full solves and reused solutions so far
+  std::size_t mNumSolves;
+  std::size_t mNumSkippedSolves;
+
+  /// \brief q, filtered dq and targets (EE position, velocity, acceleration,
+  /// COM) of the last full solve
+  Eigen::Matrix<double, 25, 1> mSolvedQ;
+  Eigen::Matrix<double, 25, 1> mSolvedDq;
+  Eigen::Matrix<double, 12, 1> mSolvedTargets;
+
+  /// \brief Squared task residuals of the last solve: EEL, EER, Bal, Pose,
+  /// SpeedReg, Reg
+  Eigen::Matrix<double, 6, 1> mTaskLosses;
+
   double zCOMInit;
 
+  /// \brief Body COM target in frame 0, defaults to (0, 0, zCOMInit)
+  Eigen::Vector3d mCOMTarget;
+
   Eigen::Matrix<double, 25, 1> qInit;
 
   filter *dqFilt;
+
+  /// \brief Scratch of computeDriftTerms(): accumulated column drift
+  /// (angular and linear parts at the world origin) and kept angular
+  /// velocity of every body
+  std::vector<Eigen::Vector3d> mDriftAngular;
+  std::vector<Eigen::Vector3d> mDriftLinear;
+  std::vector<Eigen::Vector3d> mDriftOmega;
+
+#ifdef KRANG_CODEGEN
+  /// \brief Generated gripper and COM kinematics
+  KrangKinematics mKinematics;
+#endif
 };
 
 #endif  // EXAMPLES_OPERATIONALSPACECONTROL_CONTROLLER_HPP_
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Fleet.hpp"
+
+#include <new>
+
+#include "Krang.hpp"
+#include "WheelGroundContact.hpp"
+
+//==========================================================================
+Fleet::Fleet(const dart::dynamics::SkeletonPtr& _robot)
+  : mPrototype(new dart::simulation::World) {
+  mPrototype->addSkeleton(createFloor());
+  mPrototype->addSkeleton(_robot);
+  mPrototype->setTimeStep(1.0/1000);
+  useWheelGroundContact(mPrototype);
+}
+
+//==========================================================================
+Fleet::~Fleet() {
+  for (std::size_t i = 0; i < mInstances.size(); ++i) mInstances[i].controller->~Controller();
+}
+
+//==========================================================================
+Fleet::Instance& Fleet::add(const Controller* _settings) {
+  Instance instance;
+  instance.world = mPrototype->clone();
+  instance.robot = instance.world->getSkeleton("krang");
+  void* memory = mArena.allocate(sizeof(Controller), 32);
+  instance.controller = new (memory) Controller(instance.robot, instance.robot->getBodyNode("lGripper"),
+                                                instance.robot->getBodyNode("rGripper"), &mArena);
+  if (_settings != nullptr) instance.controller->copySettings(*_settings);
+  mInstances.push_back(instance);
+  return mInstances.back();
+}
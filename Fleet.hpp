@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EXAMPLES_OPERATIONALSPACECONTROL_FLEET_HPP_
+#define EXAMPLES_OPERATIONALSPACECONTROL_FLEET_HPP_
+
+#include <dart/dart.hpp>
+#include <deque>
+
+#include "Arena.hpp"
+#include "Controller.hpp"
+
+/// \brief Many simulated Krangs built from one loaded model. Every instance
+/// is a clone of a prototype world holding the floor and the robot, so its
+/// shapes (meshes and collision geometry) are the prototype's, shared
+/// read-only. The prototype uses the analytic wheel/floor contact, which the
+/// clones inherit, so no instance builds collision geometry of its own.
+/// Controllers and their velocity filter rings come from one arena.
+class Fleet {
+public:
+  /// \brief One robot in its own world
+  struct Instance {
+    dart::simulation::WorldPtr world;
+    dart::dynamics::SkeletonPtr robot;
+    Controller* controller;
+  };
+
+  /// \brief Instances of _robot, as returned by createKrang(), with a 1 ms
+  /// time step. _robot becomes the prototype and must not be simulated.
+  explicit Fleet(const dart::dynamics::SkeletonPtr& _robot);
+
+  /// \brief Destroy the controllers; the arena goes with the fleet
+  ~Fleet();
+
+  Fleet(const Fleet&) = delete;
+  Fleet& operator=(const Fleet&) = delete;
+
+  /// \brief Add an instance in the prototype's state, taking over the
+  /// controller settings of _settings if given. The reference stays valid.
+  Instance& add(const Controller* _settings = nullptr);
+
+  /// \brief Number of instances
+  std::size_t size() const { return mInstances.size(); }
+
+  /// \brief Instance _i
+  Instance& operator[](std::size_t _i) { return mInstances[_i]; }
+
+  /// \brief The arena of the controllers
+  const Arena& getArena() const { return mArena; }
+
+private:
+  dart::simulation::WorldPtr mPrototype;
+  Arena mArena;
+  std::deque<Instance> mInstances;
+};
+
+#endif  // EXAMPLES_OPERATIONALSPACECONTROL_FLEET_HPP_
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EXAMPLES_OPERATIONALSPACECONTROL_KRANG_HPP_
+#define EXAMPLES_OPERATIONALSPACECONTROL_KRANG_HPP_
+
+#include <dart/dart.hpp>
+#include <string>
+
+#ifndef KRANG_URDF
+#define KRANG_URDF "/home/panda/myfolder/wholebodycontrol/09-URDF/Krang/Krang.urdf"
+#endif
+
+/// \brief Load Krang from _urdf and put it in the pose of _initFile, adjusted
+/// so that the COM lies right above the wheel axis. Returns nullptr if either
+/// file cannot be read.
+dart::dynamics::SkeletonPtr createKrang(const std::string& _urdf = KRANG_URDF,
+                                        const std::string& _initFile = "../defaultInit.txt");
+
+/// \brief Move _krang by (_x, _y) on the floor and turn it by _heading (rad)
+/// about the world z axis, keeping its joint angles
+void placeKrang(const dart::dynamics::SkeletonPtr& _krang, double _x, double _y,
+                double _heading);
+
+/// \brief A 50x50 m box whose top face is the z = 0 plane
+dart::dynamics::SkeletonPtr createFloor();
+
+#endif  // EXAMPLES_OPERATIONALSPACECONTROL_KRANG_HPP_
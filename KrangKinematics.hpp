@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EXAMPLES_OPERATIONALSPACECONTROL_KRANGKINEMATICS_HPP_
+#define EXAMPLES_OPERATIONALSPACECONTROL_KRANGKINEMATICS_HPP_
+
+#include <Eigen/Eigen>
+
+/// \brief Gripper and COM kinematics of Krang as used by Controller::update.
+/// update() is generated from the URDF at build time (KRANG_CODEGEN) as
+/// straight-line code without allocations or tree traversal.
+///
+/// Everything is in world coordinates. Jacobians use the 25-column layout of
+/// the controller: the columns of dofs 1-7 (base rotations other than pitch,
+/// base translation and wheels) are zero.
+struct KrangKinematics {
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /// \brief Evaluate at positions _q and velocities _dq. The Jacobian
+  /// derivatives are built from _dq and multiplied by _dqFilt, as the
+  /// controller does with its filtered velocities.
+  void update(const Eigen::Matrix<double, 25, 1>& _q,
+              const Eigen::Matrix<double, 25, 1>& _dq,
+              const Eigen::Matrix<double, 25, 1>& _dqFilt);
+
+  /// \brief Transform of the base body (body 0)
+  Eigen::Isometry3d baseTf;
+
+  /// \brief Gripper positions, velocities, Jacobians and dJ*dqFilt
+  Eigen::Vector3d xEEL, dxEEL, dJEELdq;
+  Eigen::Vector3d xEER, dxEER, dJEERdq;
+  Eigen::Matrix<double, 3, 25> JEEL, JEER;
+
+  /// \brief COM without the wheels, computed like Controller::update
+  Eigen::Vector3d bodyCOM, bodyCOMLinearVelocity;
+
+  /// \brief COM Jacobian scaled to the body without wheels, and dJ*dqFilt
+  Eigen::Matrix<double, 3, 25> JCOM;
+  Eigen::Vector3d dJCOMdq;
+};
+
+#endif  // EXAMPLES_OPERATIONALSPACECONTROL_KRANGKINEMATICS_HPP_
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "KrangSim.h"
+
+#include <algorithm>
+#include <chrono>
+#include <dart/dart.hpp>
+#include <iostream>
+#include <memory>
+
+#include "Controller.hpp"
+#include "Krang.hpp"
+#include "Snapshot.hpp"
+#include "WheelGroundContact.hpp"
+
+struct KrangSim {
+  dart::simulation::WorldPtr world;
+  dart::dynamics::SkeletonPtr robot;
+  std::unique_ptr<Controller> controller;
+
+  double q[KRANG_SIM_NUM_DOFS];
+  double dq[KRANG_SIM_NUM_DOFS];
+  double torques[KRANG_SIM_NUM_TORQUES];
+  double eeLeft[3];
+  double eeRight[3];
+  double com[3];
+  double time;
+  double eeTarget[3];
+  double eeTargetVelocity[3];
+  double eeTargetAcceleration[3];
+  double comTarget[3];
+  KrangSimBuffers buffers;
+
+  KrangSimTiming timing;
+  double totalTickNs;
+};
+
+//==========================================================================
+static void bindBuffers(KrangSim* _sim) {
+  KrangSimBuffers& buffers = _sim->buffers;
+  buffers.q = _sim->q;
+  buffers.dq = _sim->dq;
+  buffers.torques = _sim->torques;
+  buffers.eeLeft = _sim->eeLeft;
+  buffers.eeRight = _sim->eeRight;
+  buffers.com = _sim->com;
+  buffers.time = &_sim->time;
+  buffers.eeTarget = _sim->eeTarget;
+  buffers.eeTargetVelocity = _sim->eeTargetVelocity;
+  buffers.eeTargetAcceleration = _sim->eeTargetAcceleration;
+  buffers.comTarget = _sim->comTarget;
+}
+
+//==========================================================================
+static void syncOutputs(KrangSim* _sim) {
+  Eigen::Map<Eigen::Matrix<double, KRANG_SIM_NUM_DOFS, 1> >(_sim->q) = _sim->robot->getPositions();
+  Eigen::Map<Eigen::Matrix<double, KRANG_SIM_NUM_DOFS, 1> >(_sim->dq) = _sim->robot->getVelocities();
+  Eigen::Map<Eigen::Matrix<double, KRANG_SIM_NUM_TORQUES, 1> >(_sim->torques) = _sim->controller->mForces;
+  Eigen::Map<Eigen::Vector3d>(_sim->eeLeft) = _sim->controller->mLeftEndEffector->getTransform().translation();
+  Eigen::Map<Eigen::Vector3d>(_sim->eeRight) = _sim->controller->mRightEndEffector->getTransform().translation();
+  Eigen::Map<Eigen::Vector3d>(_sim->com) = _sim->robot->getCOM();
+  _sim->time = _sim->world->getTime();
+}
+
+//==========================================================================
+static Controller* createController(const dart::dynamics::SkeletonPtr& _robot) {
+  return new Controller(_robot, _robot->getBodyNode("lGripper"), _robot->getBodyNode("rGripper"));
+}
+
+//==========================================================================
+extern "C" KrangSim* krang_sim_create(const char* urdf, const char* initFile, int flags) {
+  try {
+    dart::dynamics::SkeletonPtr robot = createKrang(urdf ? urdf : KRANG_URDF,
+                                                    initFile ? initFile : "../defaultInit.txt");
+    if (robot == nullptr) return nullptr;
+
+    std::unique_ptr<KrangSim> sim(new KrangSim);
+    sim->world = std::make_shared<dart::simulation::World>();
+    sim->world->addSkeleton(createFloor());
+    sim->world->addSkeleton(robot);
+    sim->world->setTimeStep(1.0/1000);
+    if (flags & KRANG_SIM_FLAT_FLOOR_CONTACT) useWheelGroundContact(sim->world);
+    sim->robot = robot;
+    sim->controller.reset(createController(robot));
+    if (flags & KRANG_SIM_QUIET) sim->controller->setVerbose(false);
+    if (flags & KRANG_SIM_CLOSED_FORM) sim->controller->setSolver(Controller::CLOSED_FORM);
+    if (flags & KRANG_SIM_ACTIVE_SET) sim->controller->setSolver(Controller::ACTIVE_SET);
+    if (flags & KRANG_SIM_LAZY_SOLVE) sim->controller->setLazySolve(1e-4, 1e-3, 1e-4, 20);
+    if (flags & KRANG_SIM_BALANCE_ONLY) sim->controller->setMode(Controller::BALANCE_ONLY);
+
+    Eigen::Map<Eigen::Vector3d>(sim->eeTarget) << 0.4, 0.0, 0.8;
+    Eigen::Map<Eigen::Vector3d>(sim->eeTargetVelocity).setZero();
+    Eigen::Map<Eigen::Vector3d>(sim->eeTargetAcceleration).setZero();
+    Eigen::Map<Eigen::Vector3d>(sim->comTarget) = sim->controller->mCOMTarget;
+    bindBuffers(sim.get());
+    syncOutputs(sim.get());
+    krang_sim_reset_timing(sim.get());
+    return sim.release();
+  } catch (const std::exception& e) {
+    std::cerr << "krang_sim_create: " << e.what() << std::endl;
+  } catch (...) {
+    std::cerr << "krang_sim_create: unknown exception" << std::endl;
+  }
+  return nullptr;
+}
+
+//==========================================================================
+extern "C" KrangSim* krang_sim_clone(const KrangSim* sim) {
+  if (sim == nullptr) return nullptr;
+  try {
+    std::unique_ptr<KrangSim> clone(new KrangSim);
+    clone->world = sim->world->clone();
+    clone->robot = clone->world->getSkeleton(sim->robot->getName());
+    clone->controller.reset(createController(clone->robot));
+    clone->controller->copySettings(*sim->controller);
+    Snapshot snapshot;
+    snapshot.capture(sim->world, *sim->controller);
+    snapshot.restore(clone->world, *clone->controller);
+
+    std::copy(sim->eeTarget, sim->eeTarget + 3, clone->eeTarget);
+    std::copy(sim->eeTargetVelocity, sim->eeTargetVelocity + 3, clone->eeTargetVelocity);
+    std::copy(sim->eeTargetAcceleration, sim->eeTargetAcceleration + 3, clone->eeTargetAcceleration);
+    std::copy(sim->comTarget, sim->comTarget + 3, clone->comTarget);
+    clone->timing = sim->timing;
+    clone->totalTickNs = sim->totalTickNs;
+    bindBuffers(clone.get());
+    syncOutputs(clone.get());
+    return clone.release();
+  } catch (const std::exception& e) {
+    std::cerr << "krang_sim_clone: " << e.what() << std::endl;
+  } catch (...) {
+    std::cerr << "krang_sim_clone: unknown exception" << std::endl;
+  }
+  return nullptr;
+}
+
+//==========================================================================
+extern "C" void krang_sim_destroy(KrangSim* sim) {
+  delete sim;
+}
+
+//==========================================================================
+extern "C" const KrangSimBuffers* krang_sim_buffers(KrangSim* sim) {
+  return sim ? &sim->buffers : nullptr;
+}
+
+//==========================================================================
+extern "C" int krang_sim_step(KrangSim* sim, int n) {
+  if (sim == nullptr) return -1;
+  typedef std::chrono::steady_clock Clock;
+  int i = 0;
+  try {
+    for (; i < n; ++i) {
+      Clock::time_point start = Clock::now();
+      sim->controller->setCOMTarget(Eigen::Map<const Eigen::Vector3d>(sim->comTarget));
+      sim->controller->update(Eigen::Map<const Eigen::Vector3d>(sim->eeTarget),
+                              Eigen::Map<const Eigen::Vector3d>(sim->eeTargetVelocity),
+                              Eigen::Map<const Eigen::Vector3d>(sim->eeTargetAcceleration));
+      Clock::time_point updated = Clock::now();
+      sim->world->step();
+      Clock::time_point stepped = Clock::now();
+
+      KrangSimTiming& timing = sim->timing;
+      timing.lastUpdateNs = std::chrono::duration<double, std::nano>(updated - start).count();
+      timing.lastStepNs = std::chrono::duration<double, std::nano>(stepped - updated).count();
+      timing.lastTickNs = timing.lastUpdateNs + timing.lastStepNs;
+      timing.maxTickNs = std::max(timing.maxTickNs, timing.lastTickNs);
+      sim->totalTickNs += timing.lastTickNs;
+      ++timing.ticks;
+      timing.meanTickNs = sim->totalTickNs/timing.ticks;
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "krang_sim_step: " << e.what() << std::endl;
+  } catch (...) {
+    std::cerr << "krang_sim_step: unknown exception" << std::endl;
+  }
+  syncOutputs(sim);
+  return i;
+}
+
+//==========================================================================
+extern "C" void krang_sim_timing(const KrangSim* sim, KrangSimTiming* timing) {
+  if (sim != nullptr && timing != nullptr) *timing = sim->timing;
+}
+
+//==========================================================================
+extern "C" void krang_sim_reset_timing(KrangSim* sim) {
+  if (sim == nullptr) return;
+  sim->timing.ticks = 0;
+  sim->timing.lastUpdateNs = sim->timing.lastStepNs = sim->timing.lastTickNs = 0.0;
+  sim->timing.meanTickNs = sim->timing.maxTickNs = 0.0;
+  sim->totalTickNs = 0.0;
+}
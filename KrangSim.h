@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EXAMPLES_OPERATIONALSPACECONTROL_KRANGSIM_H_
+#define EXAMPLES_OPERATIONALSPACECONTROL_KRANGSIM_H_
+
+/* C interface to a simulated Krang: the world with the floor and one robot,
+ * and its Controller. Every buffer is allocated with the sim and stays at the
+ * same address until krang_sim_destroy(), so a caller writes its targets and
+ * reads the state and torques in place instead of passing vectors through
+ * each call. No function throws; failures return NULL or a negative count. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KRANG_SIM_NUM_DOFS 25
+#define KRANG_SIM_NUM_TORQUES 19
+
+/* Flags of krang_sim_create() */
+/** Analytic wheel/floor contact instead of the generic collision pipeline */
+#define KRANG_SIM_FLAT_FLOOR_CONTACT 0x1
+/** Closed-form QP solve instead of SLSQP */
+#define KRANG_SIM_CLOSED_FORM 0x2
+/** Reuse the last QP solution while the robot barely moves */
+#define KRANG_SIM_LAZY_SOLVE 0x4
+/** Start in the balance-only mode */
+#define KRANG_SIM_BALANCE_ONLY 0x8
+/** Silence the controller's console output (Controller::setVerbose). Only
+ *  this simulator and its clones are affected. */
+#define KRANG_SIM_QUIET 0x10
+/** Active-set QP solve with the torque and acceleration limits */
+#define KRANG_SIM_ACTIVE_SET 0x20
+
+typedef struct KrangSim KrangSim;
+
+/** Buffers of a sim. The caller writes the targets between calls to
+ *  krang_sim_step, and every tick of a call uses them as they are. Everything
+ *  else is output, synced once at the end of each krang_sim_step call and not
+ *  after each of its ticks. */
+typedef struct KrangSimBuffers {
+  /** Positions of the 25 dofs */
+  const double* q;
+  /** Velocities of the 25 dofs */
+  const double* dq;
+  /** Joint torques of dofs 6 to 24 applied in the last tick */
+  const double* torques;
+  /** World positions of the left and right end effectors and of the COM */
+  const double* eeLeft;
+  const double* eeRight;
+  const double* com;
+  /** Simulation time in s */
+  const double* time;
+  /** End effector target in frame 0, with its velocity and acceleration fed
+   *  forward */
+  double* eeTarget;
+  double* eeTargetVelocity;
+  double* eeTargetAcceleration;
+  /** Body COM target in frame 0 (x and z are tracked) */
+  double* comTarget;
+} KrangSimBuffers;
+
+/** Wall-clock timing of the ticks stepped so far, in ns */
+typedef struct KrangSimTiming {
+  uint64_t ticks;
+  /** Controller update, world step and their sum in the last tick */
+  double lastUpdateNs;
+  double lastStepNs;
+  double lastTickNs;
+  /** Mean and max of the whole tick */
+  double meanTickNs;
+  double maxTickNs;
+} KrangSimTiming;
+
+/** Load Krang from urdf (the built-in KRANG_URDF if NULL) in the pose of
+ *  initFile ("../defaultInit.txt" if NULL) onto the floor, with a 1 ms time
+ *  step and the end effector target at (0.4, 0, 0.8). flags is a combination
+ *  of the KRANG_SIM_ flags. Returns NULL if the model cannot be loaded. */
+KrangSim* krang_sim_create(const char* urdf, const char* initFile, int flags);
+
+/** Copy of sim in its current state, including the controller and the
+ *  targets, without reloading the model or rerunning the startup pose
+ *  optimization. Returns NULL on failure. */
+KrangSim* krang_sim_clone(const KrangSim* sim);
+
+/** Free sim and its buffers */
+void krang_sim_destroy(KrangSim* sim);
+
+/** The buffers of sim; the pointer and the buffers stay valid until
+ *  krang_sim_destroy() */
+const KrangSimBuffers* krang_sim_buffers(KrangSim* sim);
+
+/** Run n ticks of controller update and world step with the current targets,
+ *  then sync the output buffers. Returns the number of ticks run, which is
+ *  less than n only on failure, or -1 if sim is NULL. */
+int krang_sim_step(KrangSim* sim, int n);
+
+/** Write the timing of sim to timing */
+void krang_sim_timing(const KrangSim* sim, KrangSimTiming* timing);
+
+/** Start the timing over */
+void krang_sim_reset_timing(KrangSim* sim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* EXAMPLES_OPERATIONALSPACECONTROL_KRANGSIM_H_ */
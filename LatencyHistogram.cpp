@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "LatencyHistogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Values below 2^kSubBits are exact, each larger power of two is split in
+// 2^(kSubBits - 1) buckets
+static const unsigned kSubBits = 7;
+static const uint64_t kExact = 1u << kSubBits;
+static const uint64_t kHalf = kExact/2;
+
+//====================================================================
+LatencyHistogram::LatencyHistogram()
+  : mCounts(bucketOf(UINT64_MAX) + 1, 0) {
+  reset();
+}
+
+//====================================================================
+void LatencyHistogram::record(uint64_t _ns) {
+  ++mCounts[bucketOf(_ns)];
+  ++mCount;
+  mMin = std::min(mMin, _ns);
+  mMax = std::max(mMax, _ns);
+  mSum += _ns;
+}
+
+//====================================================================
+void LatencyHistogram::reset() {
+  std::fill(mCounts.begin(), mCounts.end(), 0);
+  mCount = 0;
+  mMin = UINT64_MAX;
+  mMax = 0;
+  mSum = 0.0;
+}
+
+//====================================================================
+uint64_t LatencyHistogram::getPercentile(double _percentile) const {
+  if (mCount == 0) return 0;
+  const uint64_t rank = std::max<uint64_t>(1, (uint64_t)std::ceil(_percentile/100.0*mCount));
+  uint64_t seen = 0;
+  for (std::size_t i = 0; i < mCounts.size(); ++i) {
+    seen += mCounts[i];
+    if (seen >= rank) return std::min(bucketMax(i), mMax);
+  }
+  return mMax;
+}
+
+//====================================================================
+std::size_t LatencyHistogram::bucketOf(uint64_t _ns) {
+  if (_ns < kExact) return (std::size_t)_ns;
+  const unsigned msb = 63 - __builtin_clzll(_ns);
+  const unsigned shift = msb - (kSubBits - 1);
+  return (std::size_t)(kExact + (shift - 1)*kHalf + ((_ns >> shift) - kHalf));
+}
+
+//====================================================================
+uint64_t LatencyHistogram::bucketMax(std::size_t _bucket) {
+  if (_bucket < kExact) return _bucket;
+  const unsigned shift = (unsigned)((_bucket - kExact)/kHalf) + 1;
+  const uint64_t sub = kHalf + (_bucket - kExact) % kHalf;
+  return ((sub + 1) << shift) - 1;
+}
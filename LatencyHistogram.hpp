@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EXAMPLES_OPERATIONALSPACECONTROL_LATENCYHISTOGRAM_HPP_
+#define EXAMPLES_OPERATIONALSPACECONTROL_LATENCYHISTOGRAM_HPP_
+
+#include <cstdint>
+#include <vector>
+
+/// \brief Histogram of durations in ns with a bounded relative error, in the
+/// style of HdrHistogram: values below 128 ns are counted exactly, larger
+/// ones in 64 linear sub-buckets per power of two (under 1.6 % error). The
+/// buckets are allocated up front, so recording never allocates.
+class LatencyHistogram {
+public:
+  /// \brief Constructor
+  LatencyHistogram();
+
+  /// \brief Count one duration
+  void record(uint64_t _ns);
+
+  /// \brief Forget all durations
+  void reset();
+
+  /// \brief Number of recorded durations
+  uint64_t getCount() const { return mCount; }
+
+  /// \brief Exact smallest, largest and mean duration
+  uint64_t getMin() const { return mCount ? mMin : 0; }
+  uint64_t getMax() const { return mMax; }
+  double getMean() const { return mCount ? mSum/mCount : 0.0; }
+
+  /// \brief Smallest duration that _percentile % (0 to 100) of the recorded
+  /// ones do not exceed, up to the bucket resolution
+  uint64_t getPercentile(double _percentile) const;
+
+private:
+  /// \brief Bucket of a duration and the largest duration of a bucket
+  static std::size_t bucketOf(uint64_t _ns);
+  static uint64_t bucketMax(std::size_t _bucket);
+
+  std::vector<uint64_t> mCounts;
+  uint64_t mCount;
+  uint64_t mMin;
+  uint64_t mMax;
+  double mSum;
+};
+
+#endif  // EXAMPLES_OPERATIONALSPACECONTROL_LATENCYHISTOGRAM_HPP_
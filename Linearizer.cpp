@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Linearizer.hpp"
+
+#include <algorithm>
+#include <vector>
+
+//==========================================================================
+Linearizer::Linearizer(const dart::simulation::WorldPtr& _world, std::size_t _numWorkers,
+                       const std::string& _robotName)
+  : mPool(_world, _numWorkers, _robotName), mRobotName(_robotName) {}
+
+//==========================================================================
+void Linearizer::linearize(const dart::simulation::WorldPtr& _world, const Controller& _controller,
+                           const Eigen::Vector3d& _target, double _stateStep, double _inputStep) {
+  const int numStates = 50, numInputs = 19;
+  mSnapshot.capture(_world, _controller);
+
+  // Branch 2k perturbs component k up, branch 2k+1 down; states come first
+  std::vector<Eigen::VectorXd> next(2*(numStates + numInputs));
+  mPool.fork(mSnapshot, next.size(), [&](std::size_t _branch, const dart::simulation::WorldPtr& _worker,
+                                         Controller& _workerController) {
+    _workerController.copySettings(_controller);
+    _workerController.setLazySolve(0.0, 0.0, 0.0, 0);
+    _workerController.setFallback(0.0);
+
+    const int k = _branch/2;
+    const double sign = (_branch%2 == 0) ? 1.0 : -1.0;
+    dart::dynamics::SkeletonPtr robot = _worker->getSkeleton(mRobotName);
+    if (k < numStates) {
+      Eigen::VectorXd x(numStates);
+      x << robot->getPositions(), robot->getVelocities();
+      x(k) += sign*_stateStep;
+      robot->setPositions(x.head(25));
+      robot->setVelocities(x.tail(25));
+    }
+    _workerController.update(_target);
+    if (k >= numStates) {
+      Eigen::VectorXd forces = robot->getForces();
+      forces(6 + k - numStates) += sign*_inputStep;
+      robot->setForces(forces);
+    }
+    _worker->step();
+
+    next[_branch].resize(numStates);
+    next[_branch] << robot->getPositions(), robot->getVelocities();
+  });
+
+  mA.resize(numStates, numStates);
+  mB.resize(numStates, numInputs);
+  for (int k = 0; k < numStates; ++k)
+    mA.col(k) = (next[2*k] - next[2*k + 1])/(2.0*_stateStep);
+  for (int k = 0; k < numInputs; ++k)
+    mB.col(k) = (next[2*(numStates + k)] - next[2*(numStates + k) + 1])/(2.0*_inputStep);
+}
+
+//==========================================================================
+Eigen::VectorXcd Linearizer::getEigenvalues() const {
+  Eigen::EigenSolver<Eigen::MatrixXd> solver(mA, false);
+  std::vector<std::complex<double> > values(solver.eigenvalues().data(),
+                                            solver.eigenvalues().data() + mA.rows());
+  std::sort(values.begin(), values.end(),
+            [](const std::complex<double>& _a, const std::complex<double>& _b) {
+              return std::abs(_a) > std::abs(_b);
+            });
+  return Eigen::Map<Eigen::VectorXcd>(values.data(), values.size());
+}
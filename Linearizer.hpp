@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EXAMPLES_OPERATIONALSPACECONTROL_LINEARIZER_HPP_
+#define EXAMPLES_OPERATIONALSPACECONTROL_LINEARIZER_HPP_
+
+#include <Eigen/Dense>
+#include <dart/dart.hpp>
+#include <string>
+
+#include "Controller.hpp"
+#include "Snapshot.hpp"
+
+/// \brief Central-difference linearization of one closed-loop control tick,
+/// x+ = f(x, u): Controller::update and World::step from the robot state
+/// x = (q, dq), 50 components, with extra torques u on dofs 6 to 24, 19
+/// components, added to the controller's. The 2 x 69 perturbed ticks run in
+/// parallel on the worker worlds of a RolloutPool, each restored from the
+/// same snapshot.
+class Linearizer {
+public:
+  /// \brief Create _numWorkers clones of _world, linearizing the skeleton
+  /// _robotName
+  Linearizer(const dart::simulation::WorldPtr& _world, std::size_t _numWorkers,
+             const std::string& _robotName = "krang");
+
+  /// \brief Linearize around the current state of _world and _controller,
+  /// with the controller tracking the end effector target _target. The
+  /// workers take over the settings of _controller, except that they solve
+  /// every tick and never fall back, since reused solutions and time budgets
+  /// are not differentiable. The velocity filter history is held at the
+  /// snapshot: dq enters the controller only through its newest sample.
+  void linearize(const dart::simulation::WorldPtr& _world, const Controller& _controller,
+                 const Eigen::Vector3d& _target, double _stateStep = 1e-6,
+                 double _inputStep = 1e-3);
+
+  /// \brief dx+/dx of the last linearize(), 50 x 50
+  const Eigen::MatrixXd& getA() const { return mA; }
+
+  /// \brief dx+/du of the last linearize(), 50 x 19
+  const Eigen::MatrixXd& getB() const { return mB; }
+
+  /// \brief Eigenvalues of A, the discrete closed-loop poles over one time
+  /// step, by decreasing magnitude. The filter history is not part of x, so
+  /// these ignore the lag of the 100-sample velocity filter (about 50 ticks)
+  /// and are not the poles of the loop that actually runs.
+  Eigen::VectorXcd getEigenvalues() const;
+
+private:
+  RolloutPool mPool;
+  std::string mRobotName;
+  Snapshot mSnapshot;
+  Eigen::MatrixXd mA;
+  Eigen::MatrixXd mB;
+};
+
+#endif  // EXAMPLES_OPERATIONALSPACECONTROL_LINEARIZER_HPP_
@@ -31,88 +31,206 @@
 
 #include "MyWindow.hpp"
 
+#include <chrono>
 #include <iostream>
 
 //====================================================================
 MyWindow::MyWindow(Controller* _controller)
   : SimWindow(),
     mController(_controller),
-    mCircleTask(false) {
+    mTrajectory(Trajectory::circle()),
+    mTrajectoryTask(false),
+    mTrajectoryStart(0.0),
+    mThreadPool(nullptr),
+    mCommandReader(nullptr),
+    mCommandStale(false),
+    mStateWriter(nullptr) {
   assert(_controller != nullptr);
 
   // Set the initial target positon to the initial position of the end effector
   // mTargetPosition = mController->getEndEffector("right")->getTransform().translation();
   mTargetPosition << 0.4, 0.0, 0.8;
+  mTargetVelocity.setZero();
+  mTargetAcceleration.setZero();
 }
 
 //====================================================================
-MyWindow::~MyWindow() {}
+MyWindow::~MyWindow() {
+  delete mTrajectory;
+  for (std::size_t i = 0; i < mOtherControllers.size(); ++i) delete mOtherControllers[i];
+  delete mThreadPool;
+  delete mCommandReader;
+  delete mStateWriter;
+}
+
+//====================================================================
+void MyWindow::setCommandReader(CommandReader* _reader) {
+  mCommandReader = _reader;
+}
+
+//====================================================================
+void MyWindow::setTargetPosition(const Eigen::Vector3d& _targetPosition) {
+  mTargetPosition = _targetPosition;
+}
+
+//====================================================================
+void MyWindow::addRobot(Controller* _controller, const Eigen::Vector3d& _targetPosition) {
+  assert(_controller != nullptr);
+  mOtherControllers.push_back(_controller);
+  mOtherTargets.push_back(_targetPosition);
+}
+
+//====================================================================
+void MyWindow::setThreadPool(ThreadPool* _pool) {
+  delete mThreadPool;
+  mThreadPool = _pool;
+}
+
+//====================================================================
+void MyWindow::setTrajectory(Trajectory* _trajectory) {
+  assert(_trajectory != nullptr);
+  delete mTrajectory;
+  mTrajectory = _trajectory;
+  mTrajectoryStart = mWorld ? mWorld->getTime() : 0.0;
+}
+
+//====================================================================
+void MyWindow::setStateWriter(StateWriter* _writer) {
+  mStateWriter = _writer;
+}
 
 //====================================================================
 void MyWindow::timeStepping() {
-  if (mCircleTask) {
-    static double time = 0.0;
-    const double dt = 0.0005;
-    const double radius = 0.6;
-    Eigen::Vector3d center = Eigen::Vector3d(0.0, 0.1, 0.0);
-
-    mTargetPosition = center;
-    mTargetPosition[0] = radius * std::sin(time);
-    mTargetPosition[1] = 0.25 * radius * std::sin(time);
-    mTargetPosition[2] = radius * std::cos(time);
-
-    time += dt;
+  std::chrono::steady_clock::time_point tickStart = std::chrono::steady_clock::now();
+
+  // Sample the trajectory by sim time, so its speed does not depend on how
+  // fast the window steps
+  if (mTrajectoryTask) {
+    mTrajectory->sample(mWorld->getTime() - mTrajectoryStart,
+                        &mTargetPosition, &mTargetVelocity, &mTargetAcceleration);
+  }
+
+  // Targets streamed by an external planner override the keyboard and the
+  // trajectory. A stale command keeps being held until a fresh one arrives.
+  if (mCommandReader) {
+    bool fresh = mCommandReader->poll();
+    if (mCommandReader->hasCommand()) {
+      const Command& command = mCommandReader->last();
+      if (command.flags & Command::EE_VALID) {
+        mTargetPosition = Eigen::Map<const Eigen::Vector3d>(command.eeTarget);
+        mTargetVelocity.setZero();
+        mTargetAcceleration.setZero();
+      }
+      if (command.flags & Command::COM_VALID)
+        mController->setCOMTarget(Eigen::Map<const Eigen::Vector3d>(command.comTarget));
+      if (fresh == mCommandStale) {
+        mCommandStale = !fresh;
+        std::cout << (mCommandStale ? "Planner commands stale, holding last target."
+                                    : "Planner commands resumed.") << std::endl;
+      }
+    }
   }
 
-  // Update the controller and apply control force to the robot
-  mController->update(mTargetPosition);
+  // Update the controllers and apply control forces to the robots. The
+  // robots are independent until the world step, so their updates run in
+  // parallel.
+  std::function<void(std::size_t)> update = [this](std::size_t _i) {
+    if (_i == 0) mController->update(mTargetPosition, mTargetVelocity, mTargetAcceleration);
+    else mOtherControllers[_i - 1]->update(mOtherTargets[_i - 1]);
+  };
+  const std::size_t numRobots = 1 + mOtherControllers.size();
+  if (mThreadPool) mThreadPool->parallelFor(numRobots, update);
+  else for (std::size_t i = 0; i < numRobots; ++i) update(i);
 
   // Step forward the simulation
   mWorld->step();
+
+  if (mStateWriter) {
+    publishState(std::chrono::duration<double, std::nano>(
+      std::chrono::steady_clock::now() - tickStart).count());
+  }
+}
+
+//====================================================================
+void MyWindow::displayTimer(int _val) {
+  // A planner that restarted may have created a new object under the
+  // channel's name. Looking it up maps memory, so it is done once per frame
+  // while no fresh command arrives rather than in the control tick.
+  if (mCommandReader && (mCommandStale || !mCommandReader->hasCommand()) &&
+      mCommandReader->checkWriter())
+    std::cout << "Planner restarted, following the new command channel." << std::endl;
+  SimWindow::displayTimer(_val);
+}
+
+//====================================================================
+void MyWindow::publishState(double _tickNs) {
+  dart::dynamics::SkeletonPtr robot = mController->getRobot();
+  StateSnapshot snapshot;
+  snapshot.tick = mController->mSteps;
+  snapshot.simTime = mWorld->getTime();
+  Eigen::Map<Eigen::Matrix<double, 25, 1> >(snapshot.q) = robot->getPositions();
+  Eigen::Map<Eigen::Matrix<double, 25, 1> >(snapshot.dq) = robot->getVelocities();
+  Eigen::Map<Eigen::Matrix<double, 19, 1> >(snapshot.forces) = mController->mForces;
+  Eigen::Map<Eigen::Vector3d>(snapshot.com) = robot->getCOM();
+  Eigen::Map<Eigen::Vector3d>(snapshot.eeLeft) = mController->mLeftEndEffector->getTransform().translation();
+  Eigen::Map<Eigen::Vector3d>(snapshot.eeRight) = mController->mRightEndEffector->getTransform().translation();
+  Eigen::Map<Eigen::Matrix<double, 6, 1> >(snapshot.losses) = mController->mTaskLosses;
+  snapshot.tickNs = _tickNs;
+  mStateWriter->publish(snapshot);
 }
 
 //====================================================================
 void MyWindow::drawWorld() const {
-  // Draw the target position
+  // Draw the target positions
   if (mRI) {
-    Eigen::Matrix<double, 4, 4> baseTf = mController->mRobot->getBodyNode(0)->getTransform().matrix();
-    double psi =  atan2(baseTf(0,0), -baseTf(1,0));
-    Eigen::Transform<double, 3, Eigen::Affine> Tf0 = Eigen::Transform<double, 3, Eigen::Affine>::Identity();
-    Tf0.rotate(Eigen::AngleAxisd(psi, Eigen::Vector3d::UnitZ()));
-
-    mRI->setPenColor(Eigen::Vector3d(0.8, 0.2, 0.2));
-    mRI->pushMatrix();
-    mRI->translate( \
-      (mController->mRobot->getPositions()).segment(3,3) \
-      + Tf0.matrix().block<3, 3>(0, 0)*mTargetPosition);
-    mRI->drawEllipsoid(Eigen::Vector3d(0.05, 0.05, 0.05));
-    mRI->popMatrix();    
-
-    mRI->setPenColor(Eigen::Vector3d(0.2, 0.2, 0.8));
-    mRI->pushMatrix();
-    mRI->translate(mWorld->getSkeleton("krang")->getCOM());
-    mRI->drawEllipsoid(Eigen::Vector3d(0.05, 0.05, 0.05));
-    mRI->popMatrix();    
-    
+    drawRobotTargets(mController, mTargetPosition);
+    for (std::size_t i = 0; i < mOtherControllers.size(); ++i)
+      drawRobotTargets(mOtherControllers[i], mOtherTargets[i]);
   }
 
   // Draw world
   SimWindow::drawWorld();
 }
 
+//====================================================================
+void MyWindow::drawRobotTargets(const Controller* _controller,
+                                const Eigen::Vector3d& _targetPosition) const {
+  Eigen::Matrix<double, 4, 4> baseTf = _controller->mRobot->getBodyNode(0)->getTransform().matrix();
+  double psi =  atan2(baseTf(0,0), -baseTf(1,0));
+  Eigen::Transform<double, 3, Eigen::Affine> Tf0 = Eigen::Transform<double, 3, Eigen::Affine>::Identity();
+  Tf0.rotate(Eigen::AngleAxisd(psi, Eigen::Vector3d::UnitZ()));
+
+  mRI->setPenColor(Eigen::Vector3d(0.8, 0.2, 0.2));
+  mRI->pushMatrix();
+  mRI->translate( \
+    (_controller->mRobot->getPositions()).segment(3,3) \
+    + Tf0.matrix().block<3, 3>(0, 0)*_targetPosition);
+  mRI->drawEllipsoid(Eigen::Vector3d(0.05, 0.05, 0.05));
+  mRI->popMatrix();
+
+  mRI->setPenColor(Eigen::Vector3d(0.2, 0.2, 0.8));
+  mRI->pushMatrix();
+  mRI->translate(_controller->mRobot->getCOM());
+  mRI->drawEllipsoid(Eigen::Vector3d(0.05, 0.05, 0.05));
+  mRI->popMatrix();
+}
+
 //====================================================================
 void MyWindow::keyboard(unsigned char _key, int _x, int _y) {
   double incremental = 0.01;
 
   switch (_key) {
-    case 'c':  // print debug information
-      if (mCircleTask) {
-        std::cout << "Circle task [off]." << std::endl;
-        mCircleTask = false;
+    case 'c':  // track the trajectory from its start
+      if (mTrajectoryTask) {
+        std::cout << "Trajectory task [off]." << std::endl;
+        mTrajectoryTask = false;
+        mTargetVelocity.setZero();
+        mTargetAcceleration.setZero();
       }
       else {
-        std::cout << "Circle task [on]." << std::endl;
-        mCircleTask = true;
+        std::cout << "Trajectory task [on]." << std::endl;
+        mTrajectoryTask = true;
+        mTrajectoryStart = mWorld->getTime();
       }
       break;
     case 'q':
@@ -35,7 +35,11 @@
 #include <dart/dart.hpp>
 #include <dart/gui/gui.hpp>
 
+#include "CommandChannel.hpp"
 #include "Controller.hpp"
+#include "StateChannel.hpp"
+#include "ThreadPool.hpp"
+#include "Trajectory.hpp"
 
 /// \brief class MyWindow
 class MyWindow : public dart::gui::SimWindow
@@ -56,15 +60,72 @@ public:
   // Documentation inherited
   void keyboard(unsigned char _key, int _x, int _y) override;
 
+  // Documentation inherited
+  void displayTimer(int _val) override;
+
+  /// \brief Set the end effector target of the robot of mController
+  void setTargetPosition(const Eigen::Vector3d& _targetPosition);
+
+  /// \brief Simulate one more robot, in the same world, holding the fixed
+  /// end effector target _targetPosition. Takes ownership of _controller.
+  void addRobot(Controller* _controller, const Eigen::Vector3d& _targetPosition);
+
+  /// \brief Update the controllers of all robots on _pool every time step
+  /// instead of one after the other. Takes ownership.
+  void setThreadPool(ThreadPool* _pool);
+
+  /// \brief Replace the trajectory tracked when the trajectory task is on
+  /// (a circle by default). Takes ownership.
+  void setTrajectory(Trajectory* _trajectory);
+
+  /// \brief Take targets from an external planner, polled every time step
+  void setCommandReader(CommandReader* _reader);
+
+  /// \brief Publish a state snapshot to monitors after every time step
+  void setStateWriter(StateWriter* _writer);
+
 private:
+  /// \brief Draw the end effector target and the COM of a robot
+  void drawRobotTargets(const Controller* _controller,
+                        const Eigen::Vector3d& _targetPosition) const;
+
+  /// \brief Fill and publish the snapshot of the tick that took _tickNs
+  void publishState(double _tickNs);
+
   /// \brief Operational space controller
   Controller* mController;
 
   /// \brief Target end effector position of the robot
   Eigen::Vector3d mTargetPosition;
 
-  /// \brief True to make the end effect to track a circle path
-  bool mCircleTask;
+  /// \brief Feedforward velocity and acceleration of the target
+  Eigen::Vector3d mTargetVelocity;
+  Eigen::Vector3d mTargetAcceleration;
+
+  /// \brief Trajectory tracked by the end effectors
+  Trajectory* mTrajectory;
+
+  /// \brief True to make the end effect to track mTrajectory
+  bool mTrajectoryTask;
+
+  /// \brief Sim time at which the trajectory task was turned on
+  double mTrajectoryStart;
+
+  /// \brief Controllers and targets of the robots added by addRobot
+  std::vector<Controller*> mOtherControllers;
+  std::vector<Eigen::Vector3d> mOtherTargets;
+
+  /// \brief Pool for the controller updates, nullptr to run them serially
+  ThreadPool* mThreadPool;
+
+  /// \brief Shared memory command channel, nullptr if not used
+  CommandReader* mCommandReader;
+
+  /// \brief True while the last planner command is older than the timeout
+  bool mCommandStale;
+
+  /// \brief Shared memory state publisher, nullptr if not used
+  StateWriter* mStateWriter;
 };
 
 #endif  // EXAMPLES_OPERATIONALSPACECONTROL_MYWINDOW_HPP_
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Scenario.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "Krang.hpp"
+
+//====================================================================
+bool loadScenario(const std::string& _fileName, std::vector<ScenarioRobot>* _robots) {
+  std::ifstream file(_fileName.c_str());
+  if (!file) {
+    std::cerr << "Cannot open scenario file " << _fileName << std::endl;
+    return false;
+  }
+
+  _robots->clear();
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream stream(line);
+    std::string keyword;
+    if (!(stream >> keyword) || keyword[0] == '#') continue;
+
+    ScenarioRobot robot;
+    double headingDeg;
+    if (keyword != "robot"
+        || !(stream >> robot.x >> robot.y >> headingDeg
+                    >> robot.eeTarget(0) >> robot.eeTarget(1) >> robot.eeTarget(2))) {
+      std::cerr << "Bad scenario line in " << _fileName << ": " << line << std::endl;
+      return false;
+    }
+    robot.heading = headingDeg*M_PI/180.0;
+    robot.comTarget.setZero();
+    robot.hasCOMTarget = static_cast<bool>(stream >> robot.comTarget(0) >> robot.comTarget(2));
+    _robots->push_back(robot);
+  }
+  if (_robots->empty()) {
+    std::cerr << "No robots in scenario file " << _fileName << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//====================================================================
+std::vector<Controller*> addScenarioRobots(const dart::simulation::WorldPtr& _world,
+                                           const dart::dynamics::SkeletonPtr& _prototype,
+                                           const std::vector<ScenarioRobot>& _robots) {
+  const Eigen::VectorXd qInit = _prototype->getPositions();
+  std::vector<Controller*> controllers;
+  for (std::size_t i = 0; i < _robots.size(); ++i) {
+    dart::dynamics::SkeletonPtr robot = _prototype;
+    if (i > 0) {
+      robot = _prototype->clone();
+      robot->setName("krang" + std::to_string(i));
+    }
+    robot->setPositions(qInit);
+    placeKrang(robot, _robots[i].x, _robots[i].y, _robots[i].heading);
+    _world->addSkeleton(robot);
+
+    Controller* controller = new Controller(robot, robot->getBodyNode("lGripper"),
+                                            robot->getBodyNode("rGripper"));
+    if (_robots[i].hasCOMTarget) controller->setCOMTarget(_robots[i].comTarget);
+    controllers.push_back(controller);
+  }
+  return controllers;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EXAMPLES_OPERATIONALSPACECONTROL_SCENARIO_HPP_
+#define EXAMPLES_OPERATIONALSPACECONTROL_SCENARIO_HPP_
+
+#include <dart/dart.hpp>
+#include <string>
+#include <vector>
+
+#include "Controller.hpp"
+
+/// \brief One robot of a multi-robot scenario
+struct ScenarioRobot {
+  /// \brief Placement on the floor, heading in rad
+  double x, y, heading;
+
+  /// \brief End effector target in frame 0
+  Eigen::Vector3d eeTarget;
+
+  /// \brief Body COM target in frame 0 (x and z), if given
+  bool hasCOMTarget;
+  Eigen::Vector3d comTarget;
+};
+
+/// \brief Read a scenario file with one robot per line:
+///   robot <x> <y> <heading deg> <eeX> <eeY> <eeZ> [<comX> <comZ>]
+/// Empty lines and lines starting with '#' are skipped. Returns false and
+/// prints the offending line on errors.
+bool loadScenario(const std::string& _fileName, std::vector<ScenarioRobot>* _robots);
+
+/// \brief Add one Krang per scenario robot to _world, placed as given, and
+/// return their controllers in scenario order. The first robot is _prototype
+/// itself (named "krang"), the others are clones of it named "krang1",
+/// "krang2", ..., so the URDF is loaded and the initial pose optimized once.
+std::vector<Controller*> addScenarioRobots(const dart::simulation::WorldPtr& _world,
+                                           const dart::dynamics::SkeletonPtr& _prototype,
+                                           const std::vector<ScenarioRobot>& _robots);
+
+#endif  // EXAMPLES_OPERATIONALSPACECONTROL_SCENARIO_HPP_
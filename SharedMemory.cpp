@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "SharedMemory.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+//==========================================================================
+SharedMemory* SharedMemory::create(const std::string& _name, std::size_t _size) {
+  int fd = shm_open(_name.c_str(), O_CREAT | O_RDWR, 0666);
+  if (fd < 0) {
+    std::cerr << "[shm] shm_open(" << _name << "): " << std::strerror(errno) << std::endl;
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    std::cerr << "[shm] fstat(" << _name << "): " << std::strerror(errno) << std::endl;
+    close(fd);
+    return nullptr;
+  }
+  if (static_cast<std::size_t>(st.st_size) < _size && ftruncate(fd, _size) != 0) {
+    std::cerr << "[shm] ftruncate(" << _name << "): " << std::strerror(errno) << std::endl;
+    close(fd);
+    return nullptr;
+  }
+  // Fault in and pin the pages here so the control loop never takes a page
+  // fault. MAP_POPULATE does it without writing, since a reader may still be
+  // mapping an object we reuse.
+  void* data = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    std::cerr << "[shm] mmap(" << _name << "): " << std::strerror(errno) << std::endl;
+    return nullptr;
+  }
+  mlock(data, _size);
+  return new SharedMemory(_name, data, _size);
+}
+
+//==========================================================================
+SharedMemory* SharedMemory::open(const std::string& _name, std::size_t _size) {
+  int fd = shm_open(_name.c_str(), O_RDWR, 0666);
+  if (fd < 0) return nullptr;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < _size) {
+    close(fd);
+    return nullptr;
+  }
+  void* data = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) return nullptr;
+  return new SharedMemory(_name, data, _size);
+}
+
+//==========================================================================
+SharedMemory::SharedMemory(const std::string& _name, void* _data, std::size_t _size)
+  : mName(_name),
+    mData(_data),
+    mSize(_size) {}
+
+//==========================================================================
+SharedMemory::~SharedMemory() {
+  munmap(mData, mSize);
+}
+
+//==========================================================================
+void SharedMemory::unlink() {
+  shm_unlink(mName.c_str());
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EXAMPLES_OPERATIONALSPACECONTROL_SHAREDMEMORY_HPP_
+#define EXAMPLES_OPERATIONALSPACECONTROL_SHAREDMEMORY_HPP_
+
+#include <cstddef>
+#include <string>
+
+/// \brief RAII wrapper around a mapped POSIX shared memory object
+class SharedMemory {
+public:
+  /// \brief Create the object _name, or reuse it if it already exists, and map
+  /// _size bytes of it. An existing object is only ever grown, never
+  /// truncated, so readers that still map it keep valid pages; its contents
+  /// are left as they are.
+  static SharedMemory* create(const std::string& _name, std::size_t _size);
+
+  /// \brief Map an existing object _name that must hold at least _size bytes.
+  /// Returns nullptr if the object does not exist yet.
+  static SharedMemory* open(const std::string& _name, std::size_t _size);
+
+  /// \brief Unmap the object. The object itself stays until unlink().
+  ~SharedMemory();
+
+  /// \brief Remove the name from the system
+  void unlink();
+
+  /// \brief Start of the mapping
+  void* data() const { return mData; }
+
+  /// \brief Size of the mapping in bytes
+  std::size_t size() const { return mSize; }
+
+private:
+  SharedMemory(const std::string& _name, void* _data, std::size_t _size);
+
+  std::string mName;
+
+  void* mData;
+
+  std::size_t mSize;
+};
+
+#endif  // EXAMPLES_OPERATIONALSPACECONTROL_SHAREDMEMORY_HPP_
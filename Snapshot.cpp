@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Snapshot.hpp"
+
+#include <algorithm>
+
+//==========================================================================
+void Snapshot::capture(const dart::simulation::WorldPtr& _world, const Controller& _controller) {
+  mData.clear();
+  mData.push_back(_world->getTime());
+  for (std::size_t i = 0; i < _world->getNumSkeletons(); ++i) {
+    dart::dynamics::SkeletonPtr skel = _world->getSkeleton(i);
+    Eigen::VectorXd q = skel->getPositions(), dq = skel->getVelocities();
+    mData.insert(mData.end(), q.data(), q.data() + q.size());
+    mData.insert(mData.end(), dq.data(), dq.data() + dq.size());
+  }
+  _controller.saveState(mData);
+}
+
+//==========================================================================
+void Snapshot::restore(const dart::simulation::WorldPtr& _world, Controller& _controller) const {
+  const double* in = mData.data();
+  _world->setTime(*in++);
+  for (std::size_t i = 0; i < _world->getNumSkeletons(); ++i) {
+    dart::dynamics::SkeletonPtr skel = _world->getSkeleton(i);
+    const int dof = skel->getNumDofs();
+    skel->setPositions(Eigen::Map<const Eigen::VectorXd>(in, dof)); in += dof;
+    skel->setVelocities(Eigen::Map<const Eigen::VectorXd>(in, dof)); in += dof;
+  }
+  in = _controller.loadState(in);
+  assert(in == mData.data() + mData.size());
+}
+
+//==========================================================================
+RolloutPool::RolloutPool(const dart::simulation::WorldPtr& _world, std::size_t _numWorkers,
+                         const std::string& _robotName)
+  : mThreadPool(_numWorkers) {
+  for (std::size_t i = 0; i < _numWorkers; ++i) {
+    Worker worker;
+    worker.world = _world->clone();
+    dart::dynamics::SkeletonPtr robot = worker.world->getSkeleton(_robotName);
+    worker.controller = new Controller(robot, robot->getBodyNode("lGripper"), robot->getBodyNode("rGripper"));
+    mWorkers.push_back(worker);
+  }
+}
+
+//==========================================================================
+RolloutPool::~RolloutPool() {
+  for (std::size_t i = 0; i < mWorkers.size(); ++i) delete mWorkers[i].controller;
+}
+
+//==========================================================================
+void RolloutPool::fork(const Snapshot& _snapshot, std::size_t _numBranches, const Branch& _branch) {
+  // Index w of the loop owns worker w, so no two threads share a world
+  std::function<void(std::size_t)> run = [this, &_snapshot, _numBranches, &_branch](std::size_t _w) {
+    Worker& worker = mWorkers[_w];
+    for (std::size_t b = _w; b < _numBranches; b += mWorkers.size()) {
+      _snapshot.restore(worker.world, *worker.controller);
+      _branch(b, worker.world, *worker.controller);
+    }
+  };
+  mThreadPool.parallelFor(std::min(mWorkers.size(), _numBranches), run);
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EXAMPLES_OPERATIONALSPACECONTROL_SNAPSHOT_HPP_
+#define EXAMPLES_OPERATIONALSPACECONTROL_SNAPSHOT_HPP_
+
+#include <dart/dart.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Controller.hpp"
+#include "ThreadPool.hpp"
+
+/// \brief Flat copy of a simulation: world time, positions and velocities of
+/// every skeleton, and the internal state of its controller
+class Snapshot {
+public:
+  /// \brief Capture _world and _controller. The buffer is reused, so repeated
+  /// captures do not allocate.
+  void capture(const dart::simulation::WorldPtr& _world, const Controller& _controller);
+
+  /// \brief Restore into _world and _controller. _world must hold the same
+  /// skeletons as the captured one, e.g. a clone of it.
+  void restore(const dart::simulation::WorldPtr& _world, Controller& _controller) const;
+
+  /// \brief The flat buffer
+  const std::vector<double>& data() const { return mData; }
+
+private:
+  std::vector<double> mData;
+};
+
+/// \brief Worker worlds for branching rollouts: each worker is a clone of the
+/// world with its own Controller, so branches never reload the URDF or rerun
+/// the startup optimization.
+class RolloutPool {
+public:
+  /// \brief Runs one branch in a worker, right after the snapshot was restored
+  typedef std::function<void(std::size_t _branch,
+                             const dart::simulation::WorldPtr& _world,
+                             Controller& _controller)> Branch;
+
+  /// \brief Create _numWorkers clones of _world, controlling the skeleton
+  /// _robotName in each, and a thread pool to run them
+  RolloutPool(const dart::simulation::WorldPtr& _world, std::size_t _numWorkers,
+              const std::string& _robotName = "krang");
+
+  /// \brief Destructor
+  ~RolloutPool();
+
+  /// \brief Run branches 0 to _numBranches-1 from _snapshot, spread over the
+  /// workers in parallel on the pool's threads. Returns when all of them are
+  /// done.
+  void fork(const Snapshot& _snapshot, std::size_t _numBranches, const Branch& _branch);
+
+  /// \brief Number of worker worlds
+  std::size_t getNumWorkers() const { return mWorkers.size(); }
+
+private:
+  struct Worker {
+    dart::simulation::WorldPtr world;
+    Controller* controller;
+  };
+
+  std::vector<Worker> mWorkers;
+
+  /// \brief One thread per worker, kept across fork() calls
+  ThreadPool mThreadPool;
+};
+
+#endif  // EXAMPLES_OPERATIONALSPACECONTROL_SNAPSHOT_HPP_
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "StateChannel.hpp"
+
+#include <time.h>
+#include <algorithm>
+#include <iostream>
+#include <new>
+
+//==========================================================================
+StateWriter* StateWriter::create(const std::string& _name) {
+  SharedMemory* shm = SharedMemory::create(_name, sizeof(StateSegment));
+  if (shm == nullptr) return nullptr;
+  return new StateWriter(shm);
+}
+
+//==========================================================================
+StateWriter::StateWriter(SharedMemory* _shm)
+  : mShm(_shm),
+    mMaxTickNs(0.0) {
+  // A monitor may still map the segment of a previous writer; keep counting
+  // from its sequence so the monitor never sees an old value come back. If
+  // that writer died inside publish() the sequence is odd, round it up so
+  // that odd keeps meaning a write in progress.
+  mSegment = static_cast<StateSegment*>(mShm->data());
+  if (mSegment->magic != StateSegment::kMagic || mSegment->size != sizeof(StateSegment)) {
+    mSegment = new (mShm->data()) StateSegment;
+    mSegment->sequence.store(0, std::memory_order_relaxed);
+  } else {
+    uint64_t sequence = mSegment->sequence.load(std::memory_order_relaxed);
+    mSegment->sequence.store(sequence + (sequence & 1), std::memory_order_relaxed);
+  }
+  mSegment->size = sizeof(StateSegment);
+  std::atomic_thread_fence(std::memory_order_release);
+  mSegment->magic = StateSegment::kMagic;
+}
+
+//==========================================================================
+StateWriter::~StateWriter() {
+  delete mShm;
+}
+
+//==========================================================================
+void StateWriter::publish(StateSnapshot& _snapshot) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  _snapshot.stampNs = static_cast<uint64_t>(ts.tv_sec)*1000000000ull + ts.tv_nsec;
+  mMaxTickNs = std::max(mMaxTickNs, _snapshot.tickNs);
+  _snapshot.maxTickNs = mMaxTickNs;
+
+  uint64_t sequence = mSegment->sequence.load(std::memory_order_relaxed);
+  mSegment->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  mSegment->snapshot = _snapshot;
+  mSegment->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+//==========================================================================
+StateReader* StateReader::open(const std::string& _name) {
+  SharedMemory* shm = SharedMemory::open(_name, sizeof(StateSegment));
+  if (shm == nullptr) return nullptr;
+  const StateSegment* segment = static_cast<const StateSegment*>(shm->data());
+  if (segment->magic != StateSegment::kMagic || segment->size != sizeof(StateSegment)) {
+    std::cerr << "[state] " << _name << " is not a state segment" << std::endl;
+    delete shm;
+    return nullptr;
+  }
+  return new StateReader(shm);
+}
+
+//==========================================================================
+StateReader::StateReader(SharedMemory* _shm)
+  : mShm(_shm),
+    mSegment(static_cast<const StateSegment*>(_shm->data())) {}
+
+//==========================================================================
+StateReader::~StateReader() {
+  delete mShm;
+}
+
+//==========================================================================
+bool StateReader::read(StateSnapshot* _snapshot) const {
+  for (int attempt = 0; attempt < 100; ++attempt) {
+    uint64_t before = mSegment->sequence.load(std::memory_order_acquire);
+    if (before & 1) continue;
+    *_snapshot = mSegment->snapshot;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (mSegment->sequence.load(std::memory_order_relaxed) == before) return true;
+  }
+  return false;
+}
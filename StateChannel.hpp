@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EXAMPLES_OPERATIONALSPACECONTROL_STATECHANNEL_HPP_
+#define EXAMPLES_OPERATIONALSPACECONTROL_STATECHANNEL_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "SharedMemory.hpp"
+
+/// \brief State of the control loop after one tick
+struct StateSnapshot {
+  /// \brief Number of control ticks since start
+  uint64_t tick;
+
+  /// \brief World time in s
+  double simTime;
+
+  /// \brief CLOCK_MONOTONIC time (ns) at which the snapshot was written
+  uint64_t stampNs;
+
+  double q[25];
+  double dq[25];
+  double forces[19];
+
+  /// \brief Whole robot COM, world frame
+  double com[3];
+
+  /// \brief Gripper positions, world frame
+  double eeLeft[3];
+  double eeRight[3];
+
+  /// \brief Task losses: EEL, EER, Bal, Pose, SpeedReg, Reg
+  double losses[6];
+
+  /// \brief Wall time of the last tick (controller update + world step)
+  double tickNs;
+
+  /// \brief Worst tick time since the writer was created
+  double maxTickNs;
+};
+
+/// \brief Layout of the shared memory object. sequence is a seqlock: odd
+/// while the writer is updating the snapshot.
+struct StateSegment {
+  static const uint32_t kMagic = 0x4b535441;  // "KSTA"
+
+  uint32_t magic;
+  uint32_t size;
+
+  alignas(64) std::atomic<uint64_t> sequence;
+
+  alignas(64) StateSnapshot snapshot;
+};
+
+/// \brief Writer side, owned by the control loop. publish() never blocks.
+class StateWriter {
+public:
+  /// \brief Create the shared memory object _name, or take over the one a
+  /// previous writer left behind. Returns nullptr on failure.
+  static StateWriter* create(const std::string& _name);
+
+  /// \brief Destructor. The object stays in place so that monitors keep
+  /// reading it across a restart of the control loop.
+  ~StateWriter();
+
+  /// \brief Publish _snapshot; maxTickNs is maintained here
+  void publish(StateSnapshot& _snapshot);
+
+private:
+  explicit StateWriter(SharedMemory* _shm);
+
+  SharedMemory* mShm;
+
+  StateSegment* mSegment;
+
+  double mMaxTickNs;
+};
+
+/// \brief Reader side for monitors. Any number of readers may attach.
+class StateReader {
+public:
+  /// \brief Map the object _name. Returns nullptr if it does not exist yet.
+  static StateReader* open(const std::string& _name);
+
+  /// \brief Destructor
+  ~StateReader();
+
+  /// \brief Copy the latest consistent snapshot into _snapshot. Returns false
+  /// if the writer kept updating it during every attempt.
+  bool read(StateSnapshot* _snapshot) const;
+
+private:
+  explicit StateReader(SharedMemory* _shm);
+
+  SharedMemory* mShm;
+
+  const StateSegment* mSegment;
+};
+
+#endif  // EXAMPLES_OPERATIONALSPACECONTROL_STATECHANNEL_HPP_
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ThreadPool.hpp"
+
+//====================================================================
+ThreadPool::ThreadPool(std::size_t _numThreads)
+  : mBody(nullptr), mCount(0), mNext(0), mBusy(0), mGeneration(0), mStop(false) {
+  for (std::size_t i = 1; i < _numThreads; ++i)
+    mThreads.push_back(std::thread(&ThreadPool::work, this));
+}
+
+//====================================================================
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mStart.notify_all();
+  for (std::size_t i = 0; i < mThreads.size(); ++i) mThreads[i].join();
+}
+
+//====================================================================
+void ThreadPool::parallelFor(std::size_t _n, const std::function<void(std::size_t)>& _body) {
+  if (mThreads.empty() || _n <= 1) {
+    for (std::size_t i = 0; i < _n; ++i) _body(i);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mBody = &_body;
+    mCount = _n;
+    mNext = 0;
+    mBusy = mThreads.size();
+    ++mGeneration;
+  }
+  mStart.notify_all();
+
+  runIndices();
+
+  std::unique_lock<std::mutex> lock(mMutex);
+  mDone.wait(lock, [this] { return mBusy == 0; });
+  mBody = nullptr;
+}
+
+//====================================================================
+void ThreadPool::work() {
+  uint64_t generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mStart.wait(lock, [&] { return mStop || mGeneration != generation; });
+      if (mStop) return;
+      generation = mGeneration;
+    }
+
+    runIndices();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (--mBusy == 0) mDone.notify_one();
+  }
+}
+
+//====================================================================
+void ThreadPool::runIndices() {
+  for (std::size_t i = mNext++; i < mCount; i = mNext++) (*mBody)(i);
+}
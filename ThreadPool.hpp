@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EXAMPLES_OPERATIONALSPACECONTROL_THREADPOOL_HPP_
+#define EXAMPLES_OPERATIONALSPACECONTROL_THREADPOOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// \brief Fixed set of threads for per-tick parallel loops. The threads are
+/// started once and wait between loops, so a loop costs a wake-up rather than
+/// a thread creation.
+class ThreadPool {
+public:
+  /// \brief Run loops on _numThreads threads, the calling thread included
+  explicit ThreadPool(std::size_t _numThreads);
+
+  /// \brief Stop and join the threads
+  ~ThreadPool();
+
+  /// \brief Call _body(i) for i in [0, _n) on all threads and return when
+  /// every call is done. Indices are handed out one at a time, so uneven
+  /// calls balance out.
+  void parallelFor(std::size_t _n, const std::function<void(std::size_t)>& _body);
+
+  /// \brief Number of threads running a loop, the calling thread included
+  std::size_t getNumThreads() const { return mThreads.size() + 1; }
+
+private:
+  /// \brief Loop of the pool threads
+  void work();
+
+  /// \brief Claim and run indices of the current loop until none are left
+  void runIndices();
+
+  std::vector<std::thread> mThreads;
+
+  std::mutex mMutex;
+
+  /// \brief Signals a new loop or the stop request to the pool threads
+  std::condition_variable mStart;
+
+  /// \brief Signals the caller that the pool threads are done
+  std::condition_variable mDone;
+
+  /// \brief The current loop
+  const std::function<void(std::size_t)>* mBody;
+  std::size_t mCount;
+  std::atomic<std::size_t> mNext;
+
+  /// \brief Pool threads still working on the current loop
+  std::size_t mBusy;
+
+  /// \brief Incremented for every loop
+  uint64_t mGeneration;
+
+  bool mStop;
+};
+
+#endif  // EXAMPLES_OPERATIONALSPACECONTROL_THREADPOOL_HPP_
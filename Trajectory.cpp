@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Trajectory.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+//====================================================================
+Trajectory::Trajectory(const Function& _function, double _duration, double _dt, bool _periodic)
+  : mDuration(_duration), mPeriodic(_periodic) {
+  assert(_duration > 0.0 && _dt > 0.0);
+
+  // Stretch the step a little so that the last row falls on _duration
+  const size_t intervals = (size_t)std::ceil(_duration/_dt);
+  mDt = _duration/intervals;
+  mTable.resize(9*(intervals + 1));
+  for (size_t i = 0; i <= intervals; ++i) {
+    Eigen::Vector3d x, dx, ddx;
+    _function(i*mDt, &x, &dx, &ddx);
+    Eigen::Map<Eigen::Matrix<double, 9, 1> > row(&mTable[9*i]);
+    row << x, dx, ddx;
+  }
+}
+
+//====================================================================
+Trajectory* Trajectory::circle(double _radius, double _omega, double _dt) {
+  Function function = [=](double _t, Eigen::Vector3d* _x, Eigen::Vector3d* _dx, Eigen::Vector3d* _ddx) {
+    const double s = std::sin(_omega*_t), c = std::cos(_omega*_t);
+    *_x << _radius*s, 0.25*_radius*s, _radius*c;
+    *_dx << _radius*_omega*c, 0.25*_radius*_omega*c, -_radius*_omega*s;
+    *_ddx = -_omega*_omega*(*_x);
+  };
+  return new Trajectory(function, 2.0*M_PI/_omega, _dt, true);
+}
+
+//====================================================================
+Trajectory* Trajectory::figureEight(const Eigen::Vector3d& _center, double _size,
+                                    double _omega, double _dt) {
+  // Lemniscate of Gerono: x = a sin(wt), z = a/2 sin(2wt)
+  Function function = [=](double _t, Eigen::Vector3d* _x, Eigen::Vector3d* _dx, Eigen::Vector3d* _ddx) {
+    const double s = std::sin(_omega*_t), c = std::cos(_omega*_t);
+    const double s2 = std::sin(2.0*_omega*_t), c2 = std::cos(2.0*_omega*_t);
+    *_x = _center + Eigen::Vector3d(_size*s, 0.0, 0.5*_size*s2);
+    *_dx << _size*_omega*c, 0.0, _size*_omega*c2;
+    *_ddx << -_size*_omega*_omega*s, 0.0, -2.0*_size*_omega*_omega*s2;
+  };
+  return new Trajectory(function, 2.0*M_PI/_omega, _dt, true);
+}
+
+//====================================================================
+Trajectory* Trajectory::minimumJerk(const Eigen::Vector3d& _from, const Eigen::Vector3d& _to,
+                                    double _duration, double _dt) {
+  Function function = [=](double _t, Eigen::Vector3d* _x, Eigen::Vector3d* _dx, Eigen::Vector3d* _ddx) {
+    const double s = _t/_duration;
+    const Eigen::Vector3d d = _to - _from;
+    *_x = _from + d*(s*s*s*(10.0 - 15.0*s + 6.0*s*s));
+    *_dx = d*(s*s*(30.0 - 60.0*s + 30.0*s*s)/_duration);
+    *_ddx = d*(s*(60.0 - 180.0*s + 120.0*s*s)/(_duration*_duration));
+  };
+  return new Trajectory(function, _duration, _dt, false);
+}
+
+//====================================================================
+Trajectory* Trajectory::fromWaypoints(const std::string& _fileName, double _dt) {
+  std::ifstream file(_fileName.c_str());
+  if (!file) {
+    std::cerr << "Cannot open waypoint file " << _fileName << std::endl;
+    return nullptr;
+  }
+
+  std::vector<double> times;
+  std::vector<Eigen::Vector3d> points;
+  bool minJerk = false;
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty()) continue;
+    if (line[0] == '#') {
+      if (line.find("minjerk") != std::string::npos) minJerk = true;
+      continue;
+    }
+    std::istringstream stream(line);
+    double t;
+    Eigen::Vector3d x;
+    if (!(stream >> t >> x(0) >> x(1) >> x(2))) {
+      std::cerr << "Bad waypoint in " << _fileName << ": " << line << std::endl;
+      return nullptr;
+    }
+    if (!times.empty() && t <= times.back()) {
+      std::cerr << "Waypoint times in " << _fileName << " must increase" << std::endl;
+      return nullptr;
+    }
+    times.push_back(t);
+    points.push_back(x);
+  }
+  const int n = (int)times.size();
+  if (n < 2) {
+    std::cerr << "Need at least two waypoints in " << _fileName << std::endl;
+    return nullptr;
+  }
+
+  // Index of the segment holding time _t
+  std::function<int(double)> segment = [times, n](double _t) {
+    int i = 0;
+    while (i < n - 2 && _t > times[i + 1]) ++i;
+    return i;
+  };
+
+  Function function;
+  const double t0 = times[0];
+  if (minJerk) {
+    // Stop at every waypoint
+    function = [=](double _t, Eigen::Vector3d* _x, Eigen::Vector3d* _dx, Eigen::Vector3d* _ddx) {
+      const int i = segment(_t + t0);
+      const double T = times[i + 1] - times[i];
+      const double s = (_t + t0 - times[i])/T;
+      const Eigen::Vector3d d = points[i + 1] - points[i];
+      *_x = points[i] + d*(s*s*s*(10.0 - 15.0*s + 6.0*s*s));
+      *_dx = d*(s*s*(30.0 - 60.0*s + 30.0*s*s)/T);
+      *_ddx = d*(s*(60.0 - 180.0*s + 120.0*s*s)/(T*T));
+    };
+  }
+  else {
+    // Natural cubic spline: solve for the second derivatives at the
+    // waypoints, zero at both ends
+    Eigen::MatrixXd A = Eigen::MatrixXd::Identity(n, n);
+    Eigen::MatrixXd rhs = Eigen::MatrixXd::Zero(n, 3);
+    for (int i = 1; i < n - 1; ++i) {
+      const double h0 = times[i] - times[i - 1], h1 = times[i + 1] - times[i];
+      A(i, i - 1) = h0;
+      A(i, i) = 2.0*(h0 + h1);
+      A(i, i + 1) = h1;
+      rhs.row(i) = 6.0*((points[i + 1] - points[i])/h1 - (points[i] - points[i - 1])/h0).transpose();
+    }
+    const Eigen::MatrixXd m = A.partialPivLu().solve(rhs);
+
+    function = [=](double _t, Eigen::Vector3d* _x, Eigen::Vector3d* _dx, Eigen::Vector3d* _ddx) {
+      const int i = segment(_t + t0);
+      const double h = times[i + 1] - times[i];
+      const double b = (_t + t0 - times[i])/h, a = 1.0 - b;
+      const Eigen::Vector3d m0 = m.row(i).transpose(), m1 = m.row(i + 1).transpose();
+      *_x = a*points[i] + b*points[i + 1] + ((a*a*a - a)*m0 + (b*b*b - b)*m1)*(h*h/6.0);
+      *_dx = (points[i + 1] - points[i])/h + ((1.0 - 3.0*a*a)*m0 + (3.0*b*b - 1.0)*m1)*(h/6.0);
+      *_ddx = a*m0 + b*m1;
+    };
+  }
+  return new Trajectory(function, times.back() - t0, _dt, false);
+}
+
+//====================================================================
+void Trajectory::sample(double _t, Eigen::Vector3d* _x, Eigen::Vector3d* _dx,
+                        Eigen::Vector3d* _ddx) const {
+  const size_t rows = mTable.size()/9;
+  if (mPeriodic) {
+    _t = std::fmod(_t, mDuration);
+    if (_t < 0.0) _t += mDuration;
+  }
+  else if (_t >= mDuration) {
+    // Hold the end point
+    *_x = Eigen::Map<const Eigen::Vector3d>(&mTable[9*(rows - 1)]);
+    _dx->setZero();
+    _ddx->setZero();
+    return;
+  }
+  if (_t < 0.0) _t = 0.0;
+
+  size_t i = (size_t)(_t/mDt);
+  if (i > rows - 2) i = rows - 2;
+  const double s = _t/mDt - i;
+  Eigen::Map<const Eigen::Matrix<double, 9, 1> > r0(&mTable[9*i]), r1(&mTable[9*(i + 1)]);
+
+  // Cubic Hermite on position and velocity using the tabulated derivatives,
+  // linear on acceleration
+  const double s2 = s*s, s3 = s2*s;
+  const double h00 = 2.0*s3 - 3.0*s2 + 1.0, h10 = s3 - 2.0*s2 + s;
+  const double h01 = -2.0*s3 + 3.0*s2, h11 = s3 - s2;
+  *_x = h00*r0.segment<3>(0) + h10*mDt*r0.segment<3>(3) + h01*r1.segment<3>(0) + h11*mDt*r1.segment<3>(3);
+  *_dx = h00*r0.segment<3>(3) + h10*mDt*r0.segment<3>(6) + h01*r1.segment<3>(3) + h11*mDt*r1.segment<3>(6);
+  *_ddx = (1.0 - s)*r0.segment<3>(6) + s*r1.segment<3>(6);
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EXAMPLES_OPERATIONALSPACECONTROL_TRAJECTORY_HPP_
+#define EXAMPLES_OPERATIONALSPACECONTROL_TRAJECTORY_HPP_
+
+#include <Eigen/Eigen>
+#include <functional>
+#include <string>
+#include <vector>
+
+/// \brief End-effector target trajectory, tabulated once at a fixed time step
+/// and sampled by simulation time. A sample is a table lookup plus Hermite
+/// interpolation, so long scripted runs do no trigonometry per tick.
+class Trajectory {
+public:
+  /// \brief Evaluates position, velocity and acceleration at a time
+  typedef std::function<void(double _t, Eigen::Vector3d* _x, Eigen::Vector3d* _dx,
+                             Eigen::Vector3d* _ddx)> Function;
+
+  /// \brief Tabulate _function on [0, _duration] every _dt. A periodic
+  /// trajectory wraps around, otherwise it holds its end point.
+  Trajectory(const Function& _function, double _duration, double _dt, bool _periodic);
+
+  /// \brief Circle in the x-z plane with a y component of 0.25 of x, the
+  /// target MyWindow used to compute every tick
+  static Trajectory* circle(double _radius = 0.6, double _omega = 0.5, double _dt = 0.01);
+
+  /// \brief Figure eight in the x-z plane around _center
+  static Trajectory* figureEight(const Eigen::Vector3d& _center = Eigen::Vector3d(0.4, 0.0, 0.8),
+                                 double _size = 0.2, double _omega = 0.5, double _dt = 0.01);
+
+  /// \brief Rest-to-rest minimum-jerk move from _from to _to in _duration
+  static Trajectory* minimumJerk(const Eigen::Vector3d& _from, const Eigen::Vector3d& _to,
+                                 double _duration, double _dt = 0.01);
+
+  /// \brief Load waypoints "t x y z", one per line, from _fileName. They are
+  /// joined by a natural cubic spline, or by rest-to-rest minimum-jerk moves
+  /// if the file has a "# minjerk" line. Returns nullptr on errors.
+  static Trajectory* fromWaypoints(const std::string& _fileName, double _dt = 0.01);
+
+  /// \brief Position, velocity and acceleration at time _t from the start
+  void sample(double _t, Eigen::Vector3d* _x, Eigen::Vector3d* _dx, Eigen::Vector3d* _ddx) const;
+
+  /// \brief Length of the table in s
+  double getDuration() const { return mDuration; }
+
+private:
+  double mDuration;
+
+  double mDt;
+
+  bool mPeriodic;
+
+  /// \brief Rows of x, dx, ddx (9 values) every mDt
+  std::vector<double> mTable;
+};
+
+#endif  // EXAMPLES_OPERATIONALSPACECONTROL_TRAJECTORY_HPP_
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "WheelGroundContact.hpp"
+
+#include <iostream>
+
+using namespace dart::collision;
+using namespace dart::dynamics;
+
+//==========================================================================
+std::shared_ptr<WheelGroundCollisionDetector> WheelGroundCollisionDetector::create(
+  const std::shared_ptr<CollisionDetector>& _detector,
+  double _radius, double _width, double _floorHeight) {
+  return std::shared_ptr<WheelGroundCollisionDetector>(
+    new WheelGroundCollisionDetector(_detector, _radius, _width, _floorHeight));
+}
+
+//==========================================================================
+WheelGroundCollisionDetector::WheelGroundCollisionDetector(
+  const std::shared_ptr<CollisionDetector>& _detector,
+  double _radius, double _width, double _floorHeight)
+  : mDetector(_detector),
+    mRadius(_radius),
+    mWidth(_width),
+    mFloorHeight(_floorHeight),
+    mCachedGroup(nullptr),
+    mCachedNumFrames(0),
+    mFilter(std::make_shared<WheelFloorFilter>()) {
+  mFilter->detector = this;
+}
+
+//==========================================================================
+std::shared_ptr<CollisionDetector> WheelGroundCollisionDetector::cloneWithoutCollisionObjects() {
+  return create(mDetector->cloneWithoutCollisionObjects(), mRadius, mWidth, mFloorHeight);
+}
+
+//==========================================================================
+const std::string& WheelGroundCollisionDetector::getType() const {
+  return getStaticType();
+}
+
+//==========================================================================
+const std::string& WheelGroundCollisionDetector::getStaticType() {
+  static const std::string type = "wheel_ground";
+  return type;
+}
+
+//==========================================================================
+const std::shared_ptr<CollisionDetector>& WheelGroundCollisionDetector::getWrappedDetector() const {
+  return mDetector;
+}
+
+//==========================================================================
+std::unique_ptr<CollisionGroup> WheelGroundCollisionDetector::createCollisionGroup() {
+  return mDetector->createCollisionGroup();
+}
+
+//==========================================================================
+std::unique_ptr<CollisionObject> WheelGroundCollisionDetector::createCollisionObject(
+  const ShapeFrame* _shapeFrame) {
+  return std::unique_ptr<CollisionObject>(new FrameObject(this, _shapeFrame));
+}
+
+//==========================================================================
+void WheelGroundCollisionDetector::refreshCollisionObject(CollisionObject* /*_object*/) {
+}
+
+//==========================================================================
+void WheelGroundCollisionDetector::notifyCollisionObjectDestroying(CollisionObject* /*_object*/) {
+}
+
+//==========================================================================
+WheelGroundCollisionDetector::FrameObject::FrameObject(CollisionDetector* _detector,
+                                                       const ShapeFrame* _shapeFrame)
+  : CollisionObject(_detector, _shapeFrame) {
+}
+
+//==========================================================================
+void WheelGroundCollisionDetector::FrameObject::updateEngineData() {
+}
+
+//==========================================================================
+void WheelGroundCollisionDetector::cacheFrames(CollisionGroup* _group) {
+  if (_group == mCachedGroup && _group->getNumShapeFrames() == mCachedNumFrames) return;
+
+  mWheels.clear();
+  mFloor.reset();
+  for (std::size_t i = 0; i < _group->getNumShapeFrames(); ++i) {
+    const ShapeFrame* frame = _group->getShapeFrame(i);
+    const ShapeNode* shapeNode = frame->asShapeNode();
+    if (shapeNode == nullptr) continue;
+    const BodyNode* body = shapeNode->getBodyNodePtr();
+
+    if (body->getSkeleton()->getName() == "floor") {
+      if (!mFloor) mFloor = createCollisionObject(frame);
+      continue;
+    }
+    if (body->getName() != "LWheel" && body->getName() != "RWheel") continue;
+
+    // One contact set per wheel body, however many shapes it carries
+    bool known = false;
+    for (std::size_t w = 0; w < mWheels.size(); ++w) known |= (mWheels[w].body == body);
+    const RevoluteJoint* joint = dynamic_cast<const RevoluteJoint*>(body->getParentJoint());
+    if (known || joint == nullptr) continue;
+
+    Wheel wheel;
+    wheel.body = body;
+    wheel.object = createCollisionObject(frame);
+    wheel.childToJoint = joint->getTransformFromChildBodyNode();
+    wheel.axis = joint->getAxis().normalized();
+    mWheels.push_back(wheel);
+  }
+  mCachedGroup = _group;
+  mCachedNumFrames = _group->getNumShapeFrames();
+}
+
+//==========================================================================
+bool WheelGroundCollisionDetector::isWheelFloorPair(const CollisionObject* _object1,
+                                                    const CollisionObject* _object2) const {
+  const ShapeNode* node1 = _object1->getShapeFrame()->asShapeNode();
+  const ShapeNode* node2 = _object2->getShapeFrame()->asShapeNode();
+  if (node1 == nullptr || node2 == nullptr) return false;
+
+  const BodyNode* body1 = node1->getBodyNodePtr();
+  const BodyNode* body2 = node2->getBodyNodePtr();
+  const bool floor1 = (body1->getSkeleton()->getName() == "floor");
+  const bool floor2 = (body2->getSkeleton()->getName() == "floor");
+  if (floor1 == floor2) return false;
+
+  const BodyNode* other = floor1 ? body2 : body1;
+  for (std::size_t w = 0; w < mWheels.size(); ++w)
+    if (mWheels[w].body == other) return true;
+  return false;
+}
+
+//==========================================================================
+bool WheelGroundCollisionDetector::WheelFloorFilter::needCollision(
+  const CollisionObject* _object1, const CollisionObject* _object2) const {
+  if (detector->isWheelFloorPair(_object1, _object2)) return false;
+  return !next || next->needCollision(_object1, _object2);
+}
+
+//==========================================================================
+bool WheelGroundCollisionDetector::collide(CollisionGroup* _group,
+                                           const CollisionOption& _option,
+                                           CollisionResult* _result) {
+  cacheFrames(_group);
+
+  // Everything but the wheel/floor pairs goes through the wrapped detector,
+  // which owns _group and also clears _result
+  CollisionOption option(_option);
+  mFilter->next = _option.collisionFilter;
+  option.collisionFilter = mFilter;
+  bool collision = mDetector->collide(_group, option, _result);
+  if (collision && _result == nullptr) return true;
+  if (!mFloor) return collision;
+  if (_result && _result->getNumContacts() >= _option.maxNumContacts) return collision;
+
+  const Eigen::Vector3d normal = Eigen::Vector3d::UnitZ();
+  for (std::size_t w = 0; w < mWheels.size(); ++w) {
+    const Wheel& wheel = mWheels[w];
+    Eigen::Isometry3d axleTf = wheel.body->getWorldTransform()*wheel.childToJoint;
+    Eigen::Vector3d axis = axleTf.linear()*wheel.axis;
+
+    // Lowest point of the rim: straight down, projected into the wheel plane
+    Eigen::Vector3d down = -normal + axis.dot(normal)*axis;
+    double norm = down.norm();
+    if (norm < 1e-6) continue;  // wheel lying flat, not a rolling contact
+    down /= norm;
+
+    const int nEdges = (mWidth > 0.0) ? 2 : 1;
+    for (int e = 0; e < nEdges; ++e) {
+      Eigen::Vector3d rim = axleTf.translation() + mRadius*down;
+      if (nEdges == 2) rim += ((e == 0) ? 0.5 : -0.5)*mWidth*axis;
+      double depth = mFloorHeight - rim.dot(normal);
+      if (depth < 0.0) continue;
+
+      collision = true;
+      if (_result == nullptr) return true;
+
+      // Normal points from the floor (object 2) to the wheel (object 1)
+      Contact contact;
+      contact.point = rim + 0.5*depth*normal;
+      contact.normal = normal;
+      contact.penetrationDepth = depth;
+      contact.collisionObject1 = wheel.object.get();
+      contact.collisionObject2 = mFloor.get();
+      _result->addContact(contact);
+      if (_result->getNumContacts() >= _option.maxNumContacts) return true;
+    }
+  }
+  return collision;
+}
+
+//==========================================================================
+bool WheelGroundCollisionDetector::collide(CollisionGroup* _group1,
+                                           CollisionGroup* _group2,
+                                           const CollisionOption& _option,
+                                           CollisionResult* _result) {
+  // Only the world's own group is handled analytically
+  return mDetector->collide(_group1, _group2, _option, _result);
+}
+
+//==========================================================================
+double WheelGroundCollisionDetector::distance(CollisionGroup* _group,
+                                              const DistanceOption& _option,
+                                              DistanceResult* _result) {
+  return mDetector->distance(_group, _option, _result);
+}
+
+//==========================================================================
+double WheelGroundCollisionDetector::distance(CollisionGroup* _group1,
+                                              CollisionGroup* _group2,
+                                              const DistanceOption& _option,
+                                              DistanceResult* _result) {
+  return mDetector->distance(_group1, _group2, _option, _result);
+}
+
+//==========================================================================
+bool useWheelGroundContact(const dart::simulation::WorldPtr& _world,
+                           double _radius, double _width) {
+  std::shared_ptr<CollisionDetector> detector =
+    _world->getConstraintSolver()->getCollisionDetector();
+  if (detector->getType() == WheelGroundCollisionDetector::getStaticType()) return true;
+
+  for (std::size_t i = 0; i < _world->getNumSkeletons(); ++i) {
+    SkeletonPtr skel = _world->getSkeleton(i);
+    if (skel->getName() == "floor") continue;
+    if (skel->getBodyNode("LWheel") == nullptr || skel->getBodyNode("RWheel") == nullptr) {
+      std::cout << "[contact] " << skel->getName()
+                << " is not a wheeled robot, keeping the generic collision pipeline" << std::endl;
+      return false;
+    }
+  }
+  _world->getConstraintSolver()->setCollisionDetector(
+    WheelGroundCollisionDetector::create(detector, _radius, _width));
+  return true;
+}
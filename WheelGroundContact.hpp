@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EXAMPLES_OPERATIONALSPACECONTROL_WHEELGROUNDCONTACT_HPP_
+#define EXAMPLES_OPERATIONALSPACECONTROL_WHEELGROUNDCONTACT_HPP_
+
+#include <dart/dart.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// \brief Collision detector for Krang on a flat floor. The wheels are treated
+/// as cylinders and their contacts with the floor plane are computed in closed
+/// form, skipping mesh narrowphase for them. Every other pair (the body or
+/// arms against the floor, robots against each other) goes through the
+/// wrapped detector, normally the world's FCL one, as usual. Collision groups
+/// are created by and belong to the wrapped detector.
+class WheelGroundCollisionDetector : public dart::collision::CollisionDetector {
+public:
+  /// \brief Wrap _detector. _radius and _width of the wheels, floor top at
+  /// z = _floorHeight. A zero width gives one contact per wheel in its middle
+  /// plane, otherwise one per rim edge that touches the floor.
+  static std::shared_ptr<WheelGroundCollisionDetector> create(
+    const std::shared_ptr<dart::collision::CollisionDetector>& _detector,
+    double _radius = 0.265, double _width = 0.0, double _floorHeight = 0.0);
+
+  // Documentation inherited
+  std::shared_ptr<dart::collision::CollisionDetector> cloneWithoutCollisionObjects() override;
+
+  // Documentation inherited
+  const std::string& getType() const override;
+
+  /// \brief Get type of this collision detector
+  static const std::string& getStaticType();
+
+  /// \brief Detector that handles everything but the wheel/floor pairs
+  const std::shared_ptr<dart::collision::CollisionDetector>& getWrappedDetector() const;
+
+  // Documentation inherited
+  std::unique_ptr<dart::collision::CollisionGroup> createCollisionGroup() override;
+
+  // Documentation inherited
+  bool collide(dart::collision::CollisionGroup* _group,
+               const dart::collision::CollisionOption& _option = dart::collision::CollisionOption(false, 1u, nullptr),
+               dart::collision::CollisionResult* _result = nullptr) override;
+
+  // Documentation inherited
+  bool collide(dart::collision::CollisionGroup* _group1,
+               dart::collision::CollisionGroup* _group2,
+               const dart::collision::CollisionOption& _option = dart::collision::CollisionOption(false, 1u, nullptr),
+               dart::collision::CollisionResult* _result = nullptr) override;
+
+  // Documentation inherited
+  double distance(dart::collision::CollisionGroup* _group,
+                  const dart::collision::DistanceOption& _option = dart::collision::DistanceOption(false, 0.0, nullptr),
+                  dart::collision::DistanceResult* _result = nullptr) override;
+
+  // Documentation inherited
+  double distance(dart::collision::CollisionGroup* _group1,
+                  dart::collision::CollisionGroup* _group2,
+                  const dart::collision::DistanceOption& _option = dart::collision::DistanceOption(false, 0.0, nullptr),
+                  dart::collision::DistanceResult* _result = nullptr) override;
+
+protected:
+  WheelGroundCollisionDetector(const std::shared_ptr<dart::collision::CollisionDetector>& _detector,
+                               double _radius, double _width, double _floorHeight);
+
+  // Documentation inherited
+  std::unique_ptr<dart::collision::CollisionObject> createCollisionObject(
+    const dart::dynamics::ShapeFrame* _shapeFrame) override;
+
+  // Documentation inherited
+  void refreshCollisionObject(dart::collision::CollisionObject* _object) override;
+
+  // Documentation inherited
+  void notifyCollisionObjectDestroying(dart::collision::CollisionObject* _object) override;
+
+private:
+  /// \brief Collision object without engine data, only carries the shape
+  /// frame of an analytic contact to the constraint solver
+  struct FrameObject : public dart::collision::CollisionObject {
+    FrameObject(dart::collision::CollisionDetector* _detector,
+                const dart::dynamics::ShapeFrame* _shapeFrame);
+
+    void updateEngineData() override;
+  };
+
+  /// \brief Filter that hands the wheel/floor pairs to the analytic path and
+  /// defers to the caller's filter for the rest
+  struct WheelFloorFilter : public dart::collision::CollisionFilter {
+    bool needCollision(const dart::collision::CollisionObject* _object1,
+                       const dart::collision::CollisionObject* _object2) const override;
+
+    const WheelGroundCollisionDetector* detector;
+
+    std::shared_ptr<dart::collision::CollisionFilter> next;
+  };
+
+  struct Wheel {
+    const dart::dynamics::BodyNode* body;
+    std::shared_ptr<dart::collision::CollisionObject> object;
+    Eigen::Isometry3d childToJoint;
+    Eigen::Vector3d axis;
+  };
+
+  /// \brief Find the wheels and the floor in _group, cached per group
+  void cacheFrames(dart::collision::CollisionGroup* _group);
+
+  /// \brief True if one object is a wheel handled analytically and the other
+  /// belongs to the floor
+  bool isWheelFloorPair(const dart::collision::CollisionObject* _object1,
+                        const dart::collision::CollisionObject* _object2) const;
+
+  std::shared_ptr<dart::collision::CollisionDetector> mDetector;
+
+  double mRadius;
+
+  double mWidth;
+
+  double mFloorHeight;
+
+  dart::collision::CollisionGroup* mCachedGroup;
+
+  std::size_t mCachedNumFrames;
+
+  std::vector<Wheel> mWheels;
+
+  std::shared_ptr<dart::collision::CollisionObject> mFloor;
+
+  std::shared_ptr<WheelFloorFilter> mFilter;
+};
+
+/// \brief Switch _world to the analytic wheel/floor contact if it holds only
+/// the "floor" skeleton and robots with LWheel/RWheel bodies, wrapping the
+/// world's current detector for all other pairs. Returns false and keeps the
+/// generic collision pipeline otherwise.
+bool useWheelGroundContact(const dart::simulation::WorldPtr& _world,
+                           double _radius = 0.265, double _width = 0.0);
+
+#endif  // EXAMPLES_OPERATIONALSPACECONTROL_WHEELGROUNDCONTACT_HPP_
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Drives Krang along the figure-eight end effector trajectory with the
+// active-set controller, recording every QP, then solves each of them three
+// ways: unbounded in closed form, bounded from a cold start, and bounded
+// warm-started from the previous tick's active set. Reports solve times,
+// iterations, active constraints and how often the unbounded solution
+// breaks the limits:
+//   BoundedQPBench [ticks] [torque limit Nm, 0 for the URDF's]
+//                  [acceleration limit] [friction coefficient]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+#include "../ActiveSetQP.hpp"
+#include "../ClosedFormQP.hpp"
+#include "../Controller.hpp"
+#include "../Krang.hpp"
+#include "../LatencyHistogram.hpp"
+#include "../Trajectory.hpp"
+
+using namespace dart::dynamics;
+using namespace dart::simulation;
+
+int main(int argc, char* argv[])
+{
+  int ticks = (argc > 1) ? atoi(argv[1]) : 5000;
+  double torqueLimit = (argc > 2) ? atof(argv[2]) : 0.0;
+  double accelerationLimit = (argc > 3) ? atof(argv[3]) : 10.0;
+  double frictionCoefficient = (argc > 4) ? atof(argv[4]) : 0.0;
+  const double damping = 1e-4;
+
+  WorldPtr world(new World);
+  world->addSkeleton(createFloor());
+  SkeletonPtr robot = createKrang();
+  if (robot == nullptr) return 1;
+  world->addSkeleton(robot);
+  world->setTimeStep(1.0/1000);
+  Controller controller(robot, robot->getBodyNode("lGripper"), robot->getBodyNode("rGripper"));
+  controller.setSolver(Controller::ACTIVE_SET, damping);
+  Eigen::Matrix<double, 19, 1> torqueLimits = controller.mTorqueLimits;
+  if (torqueLimit > 0.0) torqueLimits.setConstant(torqueLimit);
+  controller.setLimits(torqueLimits, accelerationLimit, frictionCoefficient);
+  controller.setVerbose(false);
+
+  std::unique_ptr<Trajectory> trajectory(Trajectory::figureEight());
+  std::vector<Controller::Problem, Eigen::aligned_allocator<Controller::Problem> > problems;
+  problems.reserve(ticks);
+  for (int i = 0; i < ticks; ++i) {
+    Eigen::Vector3d x, dx, ddx;
+    trajectory->sample(world->getTime(), &x, &dx, &ddx);
+    controller.update(x, dx, ddx);
+    problems.push_back(controller.mProblem);
+    world->step();
+  }
+
+  typedef std::chrono::steady_clock Clock;
+  LatencyHistogram histograms[3];
+  ActiveSetQP cold, warm;
+  long iterations[2] = {0, 0}, activeConstraints = 0;
+  int failures[3] = {0, 0, 0}, violating = 0, overBudget = 0, constraints = 0;
+  double maxViolation = 0.0;
+  for (std::size_t i = 0; i < problems.size(); ++i) {
+    const Controller::Problem& problem = problems[i];
+    Eigen::Matrix<double, 30, 1> x[3] = {problem.x0, problem.x0, problem.x0};
+    const Eigen::Matrix<double, Eigen::Dynamic, 30> P = problem.P;
+
+    Clock::time_point t0 = Clock::now();
+    if (!solveClosedFormQP(P, problem.b, problem.A, problem.c, problem.x0, damping, &x[0]))
+      ++failures[0];
+    Clock::time_point t1 = Clock::now();
+    cold.reset();
+    if (!cold.solve(problem.P, problem.b, problem.A, problem.c, problem.C, problem.d, problem.x0, damping, &x[1]))
+      ++failures[1];
+    Clock::time_point t2 = Clock::now();
+    if (!warm.solve(problem.P, problem.b, problem.A, problem.c, problem.C, problem.d, problem.x0, damping, &x[2]))
+      ++failures[2];
+    Clock::time_point t3 = Clock::now();
+
+    histograms[0].record(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    histograms[1].record(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+    histograms[2].record(std::chrono::duration_cast<std::chrono::nanoseconds>(t3 - t2).count());
+    if (t3 - t2 > std::chrono::milliseconds(1)) ++overBudget;
+    iterations[0] += cold.getNumIterations();
+    iterations[1] += warm.getNumIterations();
+    activeConstraints += warm.getActiveSet().size();
+    constraints = std::max(constraints, (int)problem.C.rows());
+
+    if (problem.C.rows() > 0) {
+      const double violation = -(problem.C*x[0] - problem.d).minCoeff();
+      if (violation > 1e-6) ++violating;
+      maxViolation = std::max(maxViolation, violation);
+    }
+  }
+
+  const double n = problems.size();
+  const char* labels[3] = {"unbounded closed form", "bounded cold start   ", "bounded warm start   "};
+  std::cout << "Recorded QPs:                   " << problems.size() << ", up to " << constraints
+            << " inequalities" << std::endl;
+  std::cout << "Failed solves (unb/cold/warm):  " << failures[0] << " / " << failures[1] << " / "
+            << failures[2] << std::endl;
+  std::cout << "Unbounded solution over limits: " << violating << " ticks, worst by " << maxViolation << std::endl;
+  std::cout << "Active inequalities (mean):     " << activeConstraints/n << std::endl;
+  std::cout << "Iterations cold / warm (mean):  " << iterations[0]/n << " / " << iterations[1]/n << std::endl;
+  std::cout << "Warm solves over 1 ms:          " << overBudget << std::endl;
+  std::cout << "Solve time (us)            mean      p50      p99      max" << std::endl;
+  for (int h = 0; h < 3; ++h) {
+    std::cout << labels[h] << "  " << histograms[h].getMean()*1e-3
+              << "  " << histograms[h].getPercentile(50.0)*1e-3
+              << "  " << histograms[h].getPercentile(99.0)*1e-3
+              << "  " << histograms[h].getMax()*1e-3 << std::endl;
+  }
+  std::cout << "Torque-clamped ticks in the run: " << controller.mNumClampedTicks << std::endl;
+  return 0;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Local test publisher for the shared memory command channel. Streams an
+// end-effector circle and a constant COM target at a fixed rate:
+//   CommandPublisher [name] [rate Hz] [duration s]
+
+#include <time.h>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "../CommandChannel.hpp"
+
+int main(int argc, char* argv[])
+{
+  std::string name = (argc > 1) ? argv[1] : "/krang_command";
+  double rate = (argc > 2) ? atof(argv[2]) : 1000.0;
+  double duration = (argc > 3) ? atof(argv[3]) : 60.0;
+
+  CommandWriter* writer = CommandWriter::create(name);
+  if (writer == nullptr) return 1;
+  std::cout << "Publishing on " << name << " at " << rate << " Hz for " << duration << " s" << std::endl;
+
+  const long periodNs = static_cast<long>(1e9/rate);
+  const double radius = 0.2, omega = 0.5;
+  struct timespec next;
+  clock_gettime(CLOCK_MONOTONIC, &next);
+  uint64_t start = monotonicNs();
+  size_t n = 0;
+  for (double t = 0.0; t < duration; t = (monotonicNs() - start)*1e-9) {
+    Command command;
+    command.stampNs = 0;
+    command.eeTarget[0] = 0.4 + radius*std::sin(omega*t);
+    command.eeTarget[1] = 0.0;
+    command.eeTarget[2] = 0.8 + radius*std::cos(omega*t);
+    command.comTarget[0] = 0.0;
+    command.comTarget[1] = 0.0;
+    command.comTarget[2] = 0.0;
+    command.flags = Command::EE_VALID;
+    writer->write(command);
+    ++n;
+
+    next.tv_nsec += periodNs;
+    while (next.tv_nsec >= 1000000000L) { next.tv_nsec -= 1000000000L; ++next.tv_sec; }
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+  }
+  std::cout << "Published " << n << " commands" << std::endl;
+
+  delete writer;
+  return 0;
+}
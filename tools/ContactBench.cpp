@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Compares World::step with the default collision pipeline and with the
+// analytic wheel/floor contact on the same controlled Krang, reporting the
+// time per step and how far the trajectories drift apart. A second case
+// leaves Krang unbalanced and presses its left gripper down until the arm
+// lands on the floor, and checks that the analytic detector still reports
+// those arm/floor contacts:
+//   ContactBench [steps] [wheel radius] [wheel width]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "../Controller.hpp"
+#include "../Krang.hpp"
+#include "../WheelGroundContact.hpp"
+
+using namespace dart::collision;
+using namespace dart::dynamics;
+using namespace dart::simulation;
+
+/// \brief Number of contacts of _world's last step between the floor and a
+/// body other than the wheels
+std::size_t countBodyFloorContacts(const WorldPtr& _world) {
+  const CollisionResult& result = _world->getConstraintSolver()->getLastCollisionResult();
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < result.getNumContacts(); ++i) {
+    const Contact& contact = result.getContact(i);
+    const BodyNode* body1 = contact.collisionObject1->getShapeFrame()->asShapeNode()->getBodyNodePtr();
+    const BodyNode* body2 = contact.collisionObject2->getShapeFrame()->asShapeNode()->getBodyNodePtr();
+    const bool floor1 = (body1->getSkeleton()->getName() == "floor");
+    const bool floor2 = (body2->getSkeleton()->getName() == "floor");
+    if (floor1 == floor2) continue;
+    const std::string& name = floor1 ? body2->getName() : body1->getName();
+    if (name != "LWheel" && name != "RWheel") ++count;
+  }
+  return count;
+}
+
+int main(int argc, char* argv[])
+{
+  int steps = (argc > 1) ? atoi(argv[1]) : 5000;
+  double radius = (argc > 2) ? atof(argv[2]) : 0.265;
+  double width = (argc > 3) ? atof(argv[3]) : 0.0;
+
+  WorldPtr generic(new World);
+  generic->addSkeleton(createFloor());
+  generic->addSkeleton(createKrang());
+  generic->setTimeStep(1.0/1000);
+
+  WorldPtr analytic = generic->clone();
+  if (!useWheelGroundContact(analytic, radius, width)) return 1;
+
+  WorldPtr worlds[2] = {generic, analytic};
+  Controller* controllers[2];
+  for (int w = 0; w < 2; ++w) {
+    SkeletonPtr robot = worlds[w]->getSkeleton("krang");
+    controllers[w] = new Controller(robot, robot->getBodyNode("lGripper"), robot->getBodyNode("rGripper"));
+    controllers[w]->setVerbose(false);
+  }
+
+  typedef std::chrono::steady_clock Clock;
+  double stepNs[2] = {0.0, 0.0};
+  double maxDq = 0.0, maxBase = 0.0;
+  Eigen::Vector3d target(0.4, 0.0, 0.8);
+  for (int i = 0; i < steps; ++i) {
+    for (int w = 0; w < 2; ++w) {
+      controllers[w]->update(target);
+      Clock::time_point start = Clock::now();
+      worlds[w]->step();
+      stepNs[w] += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+    SkeletonPtr a = generic->getSkeleton("krang"), b = analytic->getSkeleton("krang");
+    maxDq = std::max(maxDq, (a->getPositions() - b->getPositions()).tail(19).cwiseAbs().maxCoeff());
+    maxBase = std::max(maxBase, (a->getPositions() - b->getPositions()).segment(3, 3).norm());
+  }
+
+  std::cout << "Steps:                         " << steps << std::endl;
+  std::cout << "Generic  World::step:          " << stepNs[0]/steps*1e-3 << " us" << std::endl;
+  std::cout << "Analytic World::step:          " << stepNs[1]/steps*1e-3 << " us" << std::endl;
+  std::cout << "Speedup:                       " << stepNs[0]/stepNs[1] << "x" << std::endl;
+  std::cout << "Max joint difference:          " << maxDq << " rad" << std::endl;
+  std::cout << "Max base position difference:  " << maxBase << " m" << std::endl;
+
+  delete controllers[0];
+  delete controllers[1];
+
+  // Arm on the floor: no controller, the left gripper pushed down
+  WorldPtr falling[2] = {WorldPtr(new World), nullptr};
+  falling[0]->addSkeleton(createFloor());
+  falling[0]->addSkeleton(createKrang());
+  falling[0]->setTimeStep(1.0/1000);
+  falling[1] = falling[0]->clone();
+  if (!useWheelGroundContact(falling[1], radius, width)) return 1;
+
+  std::size_t armContacts[2] = {0, 0};
+  for (int i = 0; i < steps; ++i) {
+    for (int w = 0; w < 2; ++w) {
+      falling[w]->getSkeleton("krang")->getBodyNode("lGripper")->addExtForce(Eigen::Vector3d(0.0, 0.0, -200.0));
+      falling[w]->step();
+      armContacts[w] = std::max(armContacts[w], countBodyFloorContacts(falling[w]));
+    }
+  }
+
+  std::cout << "Generic  body/floor contacts:  " << armContacts[0] << std::endl;
+  std::cout << "Analytic body/floor contacts:  " << armContacts[1] << std::endl;
+  if (armContacts[0] > 0 && armContacts[1] == 0) {
+    std::cerr << "Analytic contact dropped the arm/floor contacts" << std::endl;
+    return 1;
+  }
+  return 0;
+}
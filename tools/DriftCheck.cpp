@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Checks Controller::computeDriftTerms against the products of the Jacobian
+// derivatives it replaced, over random states, and times both:
+//   DriftCheck [states]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "../Controller.hpp"
+#include "../Krang.hpp"
+
+using namespace dart::dynamics;
+
+/// \brief dJ*_dq of the three tasks from the full Jacobian derivatives, with
+/// the column layouts of Controller::update
+void jacobianDerivProducts(Controller& _controller, const Eigen::VectorXd& _dq,
+                           Eigen::Vector3d* _dJEELdq, Eigen::Vector3d* _dJEERdq,
+                           Eigen::Vector3d* _dJCOMdq) {
+  Eigen::Vector3d zeroCol(0.0, 0.0, 0.0);
+  Eigen::Matrix<double, 3, 7> zero7Col = Eigen::Matrix<double, 3, 7>::Zero();
+
+  dart::math::LinearJacobian dJEEL_small = _controller.mLeftEndEffector->getLinearJacobianDeriv();
+  Eigen::Matrix<double, 3, 25> dJEEL_world;
+  dJEEL_world << dJEEL_small.block<3,1>(0,0), zero7Col, dJEEL_small.block<3,2>(0,6), zeroCol, dJEEL_small.block<3,7>(0,8), zero7Col;
+  *_dJEELdq = dJEEL_world*_dq;
+
+  dart::math::LinearJacobian dJEER_small = _controller.mRightEndEffector->getLinearJacobianDeriv();
+  Eigen::Matrix<double, 3, 25> dJEER_world;
+  dJEER_world << dJEER_small.block<3,1>(0,0), zero7Col, dJEER_small.block<3,2>(0,6), zeroCol, zero7Col, dJEER_small.block<3,7>(0,8);
+  *_dJEERdq = dJEER_world*_dq;
+
+  SkeletonPtr robot = _controller.mRobot;
+  Eigen::MatrixXd dJCOM_full = robot->getCOMLinearJacobianDeriv();
+  Eigen::Matrix<double, 3, 25> dJCOM_body;
+  dJCOM_body << dJCOM_full.block<3,1>(0,0), zero7Col, dJCOM_full.block<3,17>(0,8);
+  *_dJCOMdq = (robot->getMass()/(robot->getMass() - _controller.mLWheel->getMass()
+                                 - _controller.mRWheel->getMass()))*dJCOM_body*_dq;
+}
+
+int main(int argc, char* argv[])
+{
+  int states = (argc > 1) ? atoi(argv[1]) : 1000;
+
+  SkeletonPtr robot = createKrang();
+  Controller controller(robot, robot->getBodyNode("lGripper"), robot->getBodyNode("rGripper"));
+  const Eigen::VectorXd q0 = robot->getPositions();
+
+  typedef std::chrono::steady_clock Clock;
+  double productNs = 0.0, directNs = 0.0, maxError = 0.0, maxNorm = 0.0;
+  srand(0);
+  for (int i = 0; i < states; ++i) {
+    // The controller multiplies dJ, taken at the robot's velocities, with
+    // the filtered velocities, so the two differ here too
+    robot->setPositions(q0 + 0.3*Eigen::VectorXd::Random(25));
+    robot->setVelocities(Eigen::VectorXd::Random(25));
+    Eigen::VectorXd dq = Eigen::VectorXd::Random(25);
+
+    Eigen::Vector3d product[3], direct[3];
+    Clock::time_point start = Clock::now();
+    jacobianDerivProducts(controller, dq, &product[0], &product[1], &product[2]);
+    Clock::time_point middle = Clock::now();
+    controller.computeDriftTerms(dq, &direct[0], &direct[1], &direct[2]);
+    Clock::time_point end = Clock::now();
+    productNs += std::chrono::duration<double, std::nano>(middle - start).count();
+    directNs += std::chrono::duration<double, std::nano>(end - middle).count();
+
+    for (int t = 0; t < 3; ++t) {
+      maxError = std::max(maxError, (product[t] - direct[t]).norm());
+      maxNorm = std::max(maxNorm, product[t].norm());
+    }
+  }
+
+  std::cout << "States:                 " << states << std::endl;
+  std::cout << "Max |dJ*dq|:            " << maxNorm << std::endl;
+  std::cout << "Max difference:         " << maxError << std::endl;
+  std::cout << "Jacobian derivatives:   " << productNs/states*1e-3 << " us" << std::endl;
+  std::cout << "Direct drift terms:     " << directNs/states*1e-3 << " us" << std::endl;
+  return (maxError < 1e-9*std::max(1.0, maxNorm)) ? 0 : 1;
+}
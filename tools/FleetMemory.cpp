@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Builds N Krang instances and reports the resident memory they add, per
+// instance:
+//   FleetMemory [instances] [ticks] [--generic]
+// By default the instances come from a Fleet: world clones sharing the
+// model's shapes, with the analytic wheel/floor contact and arena-allocated
+// controller state. --generic builds them the plain way for comparison: a
+// world clone with the generic collision pipeline and a heap-allocated
+// Controller each. Every instance then runs [ticks] control ticks, so that
+// state built lazily on the first step (collision objects, QP scratch) is
+// counted too.
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "../Controller.hpp"
+#include "../Fleet.hpp"
+#include "../Krang.hpp"
+
+using namespace dart::dynamics;
+using namespace dart::simulation;
+
+/// \brief Resident set size of this process in bytes
+static std::size_t residentBytes() {
+  std::ifstream statm("/proc/self/statm");
+  std::size_t pages = 0, resident = 0;
+  statm >> pages >> resident;
+  return resident*sysconf(_SC_PAGESIZE);
+}
+
+int main(int argc, char* argv[])
+{
+  int numInstances = 1000, ticks = 1, positional = 0;
+  bool generic = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if (arg == "--generic") generic = true;
+    else if (positional < 2) {
+      int* values[] = {&numInstances, &ticks};
+      *values[positional++] = atoi(argv[i]);
+    } else {
+      std::cerr << "Unknown argument " << arg << std::endl;
+      return 1;
+    }
+  }
+
+  SkeletonPtr robot = createKrang();
+  if (robot == nullptr) return 1;
+
+  typedef std::chrono::steady_clock Clock;
+  const Eigen::Vector3d target(0.4, 0.0, 0.8);
+  std::unique_ptr<Fleet> fleet;
+  WorldPtr prototype;
+  std::vector<WorldPtr> worlds;
+  std::vector<Controller*> controllers;
+  if (generic) {
+    prototype.reset(new World);
+    prototype->addSkeleton(createFloor());
+    prototype->addSkeleton(robot);
+    prototype->setTimeStep(1.0/1000);
+  }
+  else fleet.reset(new Fleet(robot));
+
+  const std::size_t before = residentBytes();
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < numInstances; ++i) {
+    if (generic) {
+      worlds.push_back(prototype->clone());
+      SkeletonPtr clone = worlds.back()->getSkeleton("krang");
+      controllers.push_back(new Controller(clone, clone->getBodyNode("lGripper"), clone->getBodyNode("rGripper")));
+    }
+    else {
+      Fleet::Instance& instance = fleet->add();
+      worlds.push_back(instance.world);
+      controllers.push_back(instance.controller);
+    }
+    controllers.back()->setVerbose(false);
+  }
+  const double buildSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+  const std::size_t built = residentBytes();
+
+  start = Clock::now();
+  for (int t = 0; t < ticks; ++t) {
+    for (int i = 0; i < numInstances; ++i) {
+      controllers[i]->update(target);
+      worlds[i]->step();
+    }
+  }
+  const double stepSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+  const std::size_t stepped = residentBytes();
+
+  const double n = numInstances;
+  std::cout << (generic ? "Generic clones:            " : "Fleet instances:           ") << numInstances << std::endl;
+  std::cout << "Bytes per instance, built:  " << (built - before)/n << std::endl;
+  std::cout << "Bytes per instance, ticked: " << (stepped - before)/n << " after " << ticks << " ticks" << std::endl;
+  if (!generic) {
+    std::cout << "Arena used / reserved:      " << fleet->getArena().getBytesUsed() << " / "
+              << fleet->getArena().getBytesReserved() << " bytes" << std::endl;
+  }
+  std::cout << "Build time per instance:    " << buildSeconds/n*1e3 << " ms" << std::endl;
+  if (ticks > 0)
+    std::cout << "Tick time per instance:     " << stepSeconds/(n*ticks)*1e3 << " ms" << std::endl;
+
+  if (generic) for (int i = 0; i < numInstances; ++i) delete controllers[i];
+  return 0;
+}
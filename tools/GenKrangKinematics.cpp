@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Build-time generator for KrangKinematics::update(). Walks the skeleton
+// parsed from the URDF once and writes straight-line C++ for the body
+// transforms and velocities, the gripper Jacobians, the COM Jacobian and
+// their derivative products, with all constant transforms folded in:
+//   GenKrangKinematics <Krang.urdf> <output.cpp>
+
+#include <dart/dart.hpp>
+#include <dart/utils/urdf/urdf.hpp>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace dart::dynamics;
+
+namespace {
+
+//==========================================================================
+std::string num(double _x) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.17g", _x);
+  return buf;
+}
+
+//==========================================================================
+std::string vec(const Eigen::Vector3d& _v) {
+  return "Eigen::Vector3d(" + num(_v(0)) + ", " + num(_v(1)) + ", " + num(_v(2)) + ")";
+}
+
+//==========================================================================
+std::string mat(const Eigen::Matrix3d& _m) {
+  std::string s = "(Eigen::Matrix3d() << ";
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      s += num(_m(i, j)) + ((i == 2 && j == 2) ? "" : ", ");
+  return s + ").finished()";
+}
+
+//==========================================================================
+bool isIdentity(const Eigen::Matrix3d& _m) { return _m.isApprox(Eigen::Matrix3d::Identity(), 1e-15); }
+bool isZero(const Eigen::Vector3d& _v) { return _v.isZero(1e-15); }
+
+//==========================================================================
+// Rotation of _angle about the constant _axis, specialised for coordinate axes
+std::string axisRotation(const Eigen::Vector3d& _axis, const std::string& _angle,
+                         const std::string& _name) {
+  std::ostringstream s;
+  for (int k = 0; k < 3; ++k) {
+    if (std::abs(std::abs(_axis(k)) - 1.0) > 1e-15) continue;
+    std::string sgn = (_axis(k) > 0) ? "" : "-";
+    s << "  const double c_" << _name << " = std::cos(" << _angle << "), s_" << _name
+      << " = " << sgn << "std::sin(" << _angle << ");\n";
+    std::string c = "c_" + _name, sn = "s_" + _name, msn = "-s_" + _name;
+    std::string e[3][3];
+    int a = (k + 1) % 3, b = (k + 2) % 3;
+    for (int i = 0; i < 3; ++i) for (int j = 0; j < 3; ++j) e[i][j] = "0";
+    e[k][k] = "1"; e[a][a] = c; e[b][b] = c; e[a][b] = msn; e[b][a] = sn;
+    s << "  Eigen::Matrix3d Rq_" << _name << ";\n  Rq_" << _name << " << ";
+    for (int i = 0; i < 3; ++i)
+      for (int j = 0; j < 3; ++j)
+        s << e[i][j] << ((i == 2 && j == 2) ? ";\n" : ", ");
+    return s.str();
+  }
+  s << "  const Eigen::Matrix3d Rq_" << _name << " = Eigen::AngleAxisd(" << _angle
+    << ", " << vec(_axis.normalized()) << ").toRotationMatrix();\n";
+  return s.str();
+}
+
+struct Body {
+  std::string name;
+  int parent;
+  std::vector<int> children;
+  enum { FREE, REVOLUTE, WELD } type;
+  int dof;
+  Eigen::Isometry3d parentToJoint, childToJoint;
+  Eigen::Vector3d axis;
+  double mass;
+  Eigen::Vector3d localCOM;
+  double subtreeMass;
+};
+
+//==========================================================================
+// Columns kept by the controller: base pitch and dofs 8 to 24
+bool kept(int _dof) { return _dof == 0 || _dof >= 8; }
+
+//==========================================================================
+// Jacobian columns and dJ*dqFilt of the origin of _body for the kept dofs of
+// the joints between it and the root
+void emitPointJacobian(std::ostream& _out, const std::vector<Body>& _bodies, int _body,
+                       const std::string& _J, const std::string& _dJdq) {
+  std::string p = "p" + std::to_string(_body), v = "v" + std::to_string(_body);
+  _out << "  " << _dJdq << ".setZero();\n";
+  for (int j = _body; j >= 0; j = _bodies[j].parent) {
+    const Body& b = _bodies[j];
+    std::string id = std::to_string(j);
+    if (b.type == Body::WELD || !kept(b.dof)) continue;
+    if (b.type == Body::FREE) {
+      // Only the rotation about the first base axis (pitch) is kept
+      _out << "  " << _J << ".col(0) = R0.col(0).cross(" << p << " - p0);\n"
+           << "  " << _dJdq << " += ((om0.cross(R0.col(0))).cross(" << p << " - p0) + R0.col(0).cross("
+           << v << " - v0))*_dqFilt(0);\n";
+    }
+    else {
+      std::string k = std::to_string(b.dof);
+      _out << "  " << _J << ".col(" << k << ") = w" << id << ".cross(" << p << " - o" << id << ");\n"
+           << "  " << _dJdq << " += ((om" << id << ".cross(w" << id << ")).cross(" << p << " - o" << id
+           << ") + w" << id << ".cross(" << v << " - vo" << id << "))*_dqFilt(" << k << ");\n";
+    }
+  }
+}
+
+//==========================================================================
+// Write KrangKinematics::update() for the tree _bodies
+void emitKinematics(std::ostream& out, std::vector<Body>& bodies, const std::string& _source,
+                    int lGripper, int rGripper, int lWheel, int rWheel) {
+  for (int i = bodies.size() - 1; i >= 0; --i) {
+    bodies[i].subtreeMass = bodies[i].mass;
+    for (std::size_t c = 0; c < bodies[i].children.size(); ++c)
+      bodies[i].subtreeMass += bodies[bodies[i].children[c]].subtreeMass;
+  }
+  const double totalMass = bodies[0].subtreeMass;
+  const double wheelMass = bodies[lWheel].mass + bodies[rWheel].mass;
+
+  out << "// Generated by GenKrangKinematics from " << _source << ". Do not edit.\n\n"
+      << "#include \"KrangKinematics.hpp\"\n\n#include <cmath>\n\n"
+      << "//==========================================================================\n"
+      << "void KrangKinematics::update(const Eigen::Matrix<double, 25, 1>& _q,\n"
+      << "                             const Eigen::Matrix<double, 25, 1>& _dq,\n"
+      << "                             const Eigen::Matrix<double, 25, 1>& _dqFilt) {\n";
+
+  // Forward pass: transforms and velocities of every body
+  for (std::size_t i = 0; i < bodies.size(); ++i) {
+    const Body& b = bodies[i];
+    std::string id = std::to_string(i), pid = std::to_string(b.parent);
+    out << "  // " << b.name << "\n";
+    if (b.type == Body::FREE) {
+      out << "  const Eigen::Vector3d r0(_q(0), _q(1), _q(2));\n"
+          << "  const double th0 = r0.norm();\n"
+          << "  const Eigen::Matrix3d R0 = (th0 < 1e-12) ? Eigen::Matrix3d::Identity()\n"
+          << "    : Eigen::AngleAxisd(th0, r0/th0).toRotationMatrix();\n"
+          << "  const Eigen::Vector3d p0(_q(3), _q(4), _q(5));\n"
+          << "  const Eigen::Vector3d om0 = R0*_dq.segment<3>(0);\n"
+          << "  const Eigen::Vector3d v0 = R0*_dq.segment<3>(3);\n";
+    }
+    else if (b.type == Body::WELD) {
+      Eigen::Isometry3d T = b.parentToJoint*b.childToJoint.inverse();
+      out << "  const Eigen::Matrix3d R" << id << " = "
+          << (isIdentity(T.linear()) ? "R" + pid : "R" + pid + "*" + mat(T.linear())) << ";\n"
+          << "  const Eigen::Vector3d p" << id << " = p" << pid
+          << (isZero(T.translation()) ? "" : " + R" + pid + "*" + vec(T.translation())) << ";\n"
+          << "  const Eigen::Vector3d om" << id << " = om" << pid << ";\n"
+          << "  const Eigen::Vector3d v" << id << " = v" << pid << " + om" << pid
+          << ".cross(p" << id << " - p" << pid << ");\n";
+    }
+    else {
+      std::string k = std::to_string(b.dof);
+      Eigen::Matrix3d RPJ = b.parentToJoint.linear();
+      Eigen::Matrix3d RCJt = b.childToJoint.linear().transpose();
+      out << "  const Eigen::Matrix3d RJ" << id << " = "
+          << (isIdentity(RPJ) ? "R" + pid : "R" + pid + "*" + mat(RPJ)) << ";\n"
+          << "  const Eigen::Vector3d o" << id << " = p" << pid
+          << (isZero(b.parentToJoint.translation()) ? "" : " + R" + pid + "*" + vec(b.parentToJoint.translation())) << ";\n"
+          << "  const Eigen::Vector3d w" << id << " = RJ" << id << "*" << vec(b.axis) << ";\n"
+          << axisRotation(b.axis, "_q(" + k + ")", id)
+          << "  const Eigen::Matrix3d R" << id << " = RJ" << id << "*Rq_" << id
+          << (isIdentity(RCJt) ? "" : "*" + mat(RCJt)) << ";\n"
+          << "  const Eigen::Vector3d p" << id << " = o" << id
+          << (isZero(b.childToJoint.translation()) ? "" : " - R" + id + "*" + vec(b.childToJoint.translation())) << ";\n"
+          << "  const Eigen::Vector3d om" << id << " = om" << pid << " + w" << id << "*_dq(" << k << ");\n"
+          << "  const Eigen::Vector3d vo" << id << " = v" << pid << " + om" << pid
+          << ".cross(o" << id << " - p" << pid << ");\n"
+          << "  const Eigen::Vector3d v" << id << " = vo" << id << " + om" << id
+          << ".cross(p" << id << " - o" << id << ");\n";
+    }
+    out << "  const Eigen::Vector3d c" << id << " = p" << id
+        << (isZero(b.localCOM) ? "" : " + R" + id + "*" + vec(b.localCOM)) << ";\n"
+        << "  const Eigen::Vector3d vc" << id << " = v" << id << " + om" << id
+        << ".cross(c" << id << " - p" << id << ");\n\n";
+  }
+
+  // Backward pass: mass-weighted COM position and velocity of every subtree
+  out << "  // Subtree sums of m*c and m*dc\n";
+  for (int i = bodies.size() - 1; i >= 0; --i) {
+    const Body& b = bodies[i];
+    std::string id = std::to_string(i);
+    out << "  const Eigen::Vector3d mc" << id << " = " << num(b.mass) << "*c" << id;
+    for (std::size_t c = 0; c < b.children.size(); ++c) out << " + mc" << b.children[c];
+    out << ";\n  const Eigen::Vector3d mv" << id << " = " << num(b.mass) << "*vc" << id;
+    for (std::size_t c = 0; c < b.children.size(); ++c) out << " + mv" << b.children[c];
+    out << ";\n";
+  }
+
+  std::string lw = std::to_string(lWheel);
+  std::string bodyMass = num(totalMass - wheelMass);
+  out << "\n  baseTf.linear() = R0;\n  baseTf.translation() = p0;\n\n"
+      << "  // Grippers\n"
+      << "  xEEL = p" << lGripper << ";\n  dxEEL = v" << lGripper << ";\n"
+      << "  xEER = p" << rGripper << ";\n  dxEER = v" << rGripper << ";\n"
+      << "  JEEL.setZero();\n  JEER.setZero();\n  JCOM.setZero();\n";
+  emitPointJacobian(out, bodies, lGripper, "JEEL", "dJEELdq");
+  emitPointJacobian(out, bodies, rGripper, "JEER", "dJEERdq");
+
+  // The controller subtracts the left wheel COM for both wheels; keep that so
+  // the generated and the DART paths agree exactly.
+  out << "\n  // COM without wheels, as computed in Controller::update\n"
+      << "  bodyCOM = (mc0 - " << num(wheelMass) << "*c" << lw << ")/" << bodyMass << ";\n"
+      << "  bodyCOMLinearVelocity = (mv0 - " << num(wheelMass) << "*vc" << lw << ")/" << bodyMass << ";\n";
+  out << "  dJCOMdq.setZero();\n";
+  for (std::size_t i = 0; i < bodies.size(); ++i) {
+    const Body& b = bodies[i];
+    if (b.type == Body::WELD || !kept(b.dof)) continue;
+    std::string id = std::to_string(i);
+    std::string scale = "(1.0/" + bodyMass + ")*";
+    if (b.type == Body::FREE) {
+      out << "  JCOM.col(0) = " << scale << "R0.col(0).cross(mc0 - " << num(b.subtreeMass) << "*p0);\n"
+          << "  dJCOMdq += " << scale << "((om0.cross(R0.col(0))).cross(mc0 - " << num(b.subtreeMass)
+          << "*p0) + R0.col(0).cross(mv0 - " << num(b.subtreeMass) << "*v0))*_dqFilt(0);\n";
+    }
+    else {
+      std::string k = std::to_string(b.dof);
+      out << "  JCOM.col(" << k << ") = " << scale << "w" << id << ".cross(mc" << id << " - "
+          << num(b.subtreeMass) << "*o" << id << ");\n"
+          << "  dJCOMdq += " << scale << "((om" << id << ".cross(w" << id << ")).cross(mc" << id
+          << " - " << num(b.subtreeMass) << "*o" << id << ") + w" << id << ".cross(mv" << id
+          << " - " << num(b.subtreeMass) << "*vo" << id << "))*_dqFilt(" << k << ");\n";
+    }
+  }
+  out << "}\n";
+
+}
+
+}  // namespace
+
+//==========================================================================
+int main(int argc, char* argv[])
+{
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <Krang.urdf> <output.cpp>" << std::endl;
+    return 1;
+  }
+  dart::utils::DartLoader loader;
+  SkeletonPtr krang = loader.parseSkeleton(argv[1]);
+  if (!krang || krang->getNumDofs() != 25) {
+    std::cerr << "Expected a 25 dof Krang model in " << argv[1] << std::endl;
+    return 1;
+  }
+
+  // Collect the tree. DART orders body nodes so that parents come first.
+  std::vector<Body> bodies(krang->getNumBodyNodes());
+  int lGripper = -1, rGripper = -1, lWheel = -1, rWheel = -1;
+  for (std::size_t i = 0; i < bodies.size(); ++i) {
+    BodyNode* bn = krang->getBodyNode(i);
+    Joint* joint = bn->getParentJoint();
+    Body& b = bodies[i];
+    b.name = bn->getName();
+    b.parent = bn->getParentBodyNode() ? static_cast<int>(bn->getParentBodyNode()->getIndexInSkeleton()) : -1;
+    if (b.parent >= 0) bodies[b.parent].children.push_back(i);
+    b.parentToJoint = joint->getTransformFromParentBodyNode();
+    b.childToJoint = joint->getTransformFromChildBodyNode();
+    b.mass = bn->getMass();
+    b.localCOM = bn->getLocalCOM();
+    b.dof = joint->getNumDofs() ? static_cast<int>(joint->getIndexInSkeleton(0)) : -1;
+    if (joint->getType() == FreeJoint::getStaticType()) {
+      b.type = Body::FREE;
+      if (i != 0 || !b.parentToJoint.isApprox(Eigen::Isometry3d::Identity())
+          || !b.childToJoint.isApprox(Eigen::Isometry3d::Identity())) {
+        std::cerr << "Expected the free joint at the root with identity offsets" << std::endl;
+        return 1;
+      }
+    }
+    else if (joint->getType() == RevoluteJoint::getStaticType()) {
+      b.type = Body::REVOLUTE;
+      b.axis = static_cast<RevoluteJoint*>(joint)->getAxis();
+    }
+    else if (joint->getType() == WeldJoint::getStaticType()) {
+      b.type = Body::WELD;
+    }
+    else {
+      std::cerr << "Unsupported joint type " << joint->getType() << " of " << joint->getName() << std::endl;
+      return 1;
+    }
+    if (b.name == "lGripper") lGripper = i;
+    if (b.name == "rGripper") rGripper = i;
+    if (b.name == "LWheel") lWheel = i;
+    if (b.name == "RWheel") rWheel = i;
+  }
+  if (lGripper < 0 || rGripper < 0 || lWheel < 0 || rWheel < 0) {
+    std::cerr << "Missing lGripper, rGripper, LWheel or RWheel" << std::endl;
+    return 1;
+  }
+  std::ofstream out(argv[2]);
+  emitKinematics(out, bodies, argv[1], lGripper, rGripper, lWheel, rWheel);
+
+  std::cout << "Generated " << argv[2] << " from " << bodies.size() << " bodies" << std::endl;
+  return 0;
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Validates the generated KrangKinematics against DART on random states
+// around the initial pose and compares the time per evaluation:
+//   KinematicsBench [samples] [iterations]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+#include "../Krang.hpp"
+#include "../KrangKinematics.hpp"
+
+using namespace dart::dynamics;
+
+typedef Eigen::Matrix<double, 25, 1> Vector25d;
+
+//==========================================================================
+// The same quantities as KrangKinematics, computed through DART the way
+// Controller::update does without KRANG_CODEGEN
+void dartKinematics(const SkeletonPtr& _robot, const Vector25d& _dqFilt, KrangKinematics* _out) {
+  BodyNode* lGripper = _robot->getBodyNode("lGripper");
+  BodyNode* rGripper = _robot->getBodyNode("rGripper");
+  BodyNode* lWheel = _robot->getBodyNode("LWheel");
+  BodyNode* rWheel = _robot->getBodyNode("RWheel");
+  Eigen::Matrix<double, 3, 7> zero7Col = Eigen::Matrix<double, 3, 7>::Zero();
+  Eigen::Vector3d zeroCol = Eigen::Vector3d::Zero();
+
+  _out->baseTf = _robot->getBodyNode(0)->getTransform();
+  _out->xEEL = lGripper->getTransform().translation();
+  _out->dxEEL = lGripper->getLinearVelocity();
+  _out->xEER = rGripper->getTransform().translation();
+  _out->dxEER = rGripper->getLinearVelocity();
+
+  Eigen::Matrix<double, 3, 25> dJ;
+  dart::math::LinearJacobian J = lGripper->getLinearJacobian();
+  _out->JEEL << J.block<3,1>(0,0), zero7Col, J.block<3,2>(0,6), zeroCol, J.block<3,7>(0,8), zero7Col;
+  J = lGripper->getLinearJacobianDeriv();
+  dJ << J.block<3,1>(0,0), zero7Col, J.block<3,2>(0,6), zeroCol, J.block<3,7>(0,8), zero7Col;
+  _out->dJEELdq = dJ*_dqFilt;
+  J = rGripper->getLinearJacobian();
+  _out->JEER << J.block<3,1>(0,0), zero7Col, J.block<3,2>(0,6), zeroCol, zero7Col, J.block<3,7>(0,8);
+  J = rGripper->getLinearJacobianDeriv();
+  dJ << J.block<3,1>(0,0), zero7Col, J.block<3,2>(0,6), zeroCol, zero7Col, J.block<3,7>(0,8);
+  _out->dJEERdq = dJ*_dqFilt;
+
+  double M = _robot->getMass(), mW = lWheel->getMass() + rWheel->getMass();
+  _out->bodyCOM = (M*_robot->getCOM() - mW*lWheel->getCOM())/(M - mW);
+  _out->bodyCOMLinearVelocity = (M*_robot->getCOMLinearVelocity() - mW*lWheel->getCOMLinearVelocity())/(M - mW);
+  J = _robot->getCOMLinearJacobian();
+  _out->JCOM << J.block<3,1>(0,0), zero7Col, J.block<3,17>(0,8);
+  _out->JCOM *= M/(M - mW);
+  J = _robot->getCOMLinearJacobianDeriv();
+  dJ << J.block<3,1>(0,0), zero7Col, J.block<3,17>(0,8);
+  _out->dJCOMdq = (M/(M - mW))*dJ*_dqFilt;
+}
+
+//==========================================================================
+double maxError(const KrangKinematics& _a, const KrangKinematics& _b) {
+  double e = 0.0;
+  e = std::max(e, (_a.baseTf.matrix() - _b.baseTf.matrix()).cwiseAbs().maxCoeff());
+  e = std::max(e, (_a.xEEL - _b.xEEL).cwiseAbs().maxCoeff());
+  e = std::max(e, (_a.dxEEL - _b.dxEEL).cwiseAbs().maxCoeff());
+  e = std::max(e, (_a.xEER - _b.xEER).cwiseAbs().maxCoeff());
+  e = std::max(e, (_a.dxEER - _b.dxEER).cwiseAbs().maxCoeff());
+  e = std::max(e, (_a.JEEL - _b.JEEL).cwiseAbs().maxCoeff());
+  e = std::max(e, (_a.JEER - _b.JEER).cwiseAbs().maxCoeff());
+  e = std::max(e, (_a.dJEELdq - _b.dJEELdq).cwiseAbs().maxCoeff());
+  e = std::max(e, (_a.dJEERdq - _b.dJEERdq).cwiseAbs().maxCoeff());
+  e = std::max(e, (_a.bodyCOM - _b.bodyCOM).cwiseAbs().maxCoeff());
+  e = std::max(e, (_a.bodyCOMLinearVelocity - _b.bodyCOMLinearVelocity).cwiseAbs().maxCoeff());
+  e = std::max(e, (_a.JCOM - _b.JCOM).cwiseAbs().maxCoeff());
+  e = std::max(e, (_a.dJCOMdq - _b.dJCOMdq).cwiseAbs().maxCoeff());
+  return e;
+}
+
+//==========================================================================
+int main(int argc, char* argv[])
+{
+  int samples = (argc > 1) ? atoi(argv[1]) : 1000;
+  int iterations = (argc > 2) ? atoi(argv[2]) : 20;
+
+  SkeletonPtr robot = createKrang();
+  Vector25d qInit = robot->getPositions();
+
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+  std::vector<Vector25d, Eigen::aligned_allocator<Vector25d> > qs(samples), dqs(samples), dqFilts(samples);
+  for (int i = 0; i < samples; ++i) {
+    for (int j = 0; j < 25; ++j) {
+      qs[i](j) = qInit(j) + 0.3*uniform(rng);
+      dqs[i](j) = uniform(rng);
+      dqFilts[i](j) = dqs[i](j) + 0.1*uniform(rng);
+    }
+  }
+
+  // Validation
+  KrangKinematics generated, reference;
+  double worst = 0.0;
+  for (int i = 0; i < samples; ++i) {
+    robot->setPositions(qs[i]);
+    robot->setVelocities(dqs[i]);
+    dartKinematics(robot, dqFilts[i], &reference);
+    generated.update(qs[i], dqs[i], dqFilts[i]);
+    worst = std::max(worst, maxError(generated, reference));
+  }
+  std::cout << "Max abs difference to DART over " << samples << " states: " << worst << std::endl;
+
+  // Timing. DART recomputes lazily after setPositions/setVelocities, so both
+  // loops pay for the full kinematics of every state.
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point start = Clock::now();
+  for (int it = 0; it < iterations; ++it) {
+    for (int i = 0; i < samples; ++i) {
+      robot->setPositions(qs[i]);
+      robot->setVelocities(dqs[i]);
+      dartKinematics(robot, dqFilts[i], &reference);
+    }
+  }
+  double dartNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count()/(iterations*samples);
+
+  start = Clock::now();
+  for (int it = 0; it < iterations; ++it)
+    for (int i = 0; i < samples; ++i)
+      generated.update(qs[i], dqs[i], dqFilts[i]);
+  double generatedNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count()/(iterations*samples);
+
+  std::cout << "DART:      " << dartNs*1e-3 << " us per state" << std::endl;
+  std::cout << "Generated: " << generatedNs*1e-3 << " us per state" << std::endl;
+  std::cout << "Speedup:   " << dartNs/generatedNs << "x" << std::endl;
+
+  return (worst < 1e-9) ? 0 : 1;
+}
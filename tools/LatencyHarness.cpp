@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// cyclictest-style measurement of the control loop: Controller::update plus
+// World::step run on an absolute periodic timer, recording the wake-up
+// latency, the compute time of each part and the missed deadlines:
+//   LatencyHarness [--duration <s>] [--period <us>] [--warmup <ticks>]
+//                  [--fifo <priority>] [--cpu <n>] [--mlock]
+//                  [--closed-form | --active-set] [--lazy-solve]
+//                  [--fallback-budget <ms>]
+//                  [--balance-only] [--csv]
+// Every run prints the same table, and --csv one line per run, so that
+// profiles can be compared side by side.
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sched.h>
+#include <string>
+#include <sys/mman.h>
+#include <time.h>
+
+#include "../Controller.hpp"
+#include "../Krang.hpp"
+#include "../LatencyHistogram.hpp"
+
+using namespace dart::dynamics;
+using namespace dart::simulation;
+
+static uint64_t toNs(const timespec& _time) {
+  return (uint64_t)_time.tv_sec*1000000000ull + _time.tv_nsec;
+}
+
+static timespec fromNs(uint64_t _ns) {
+  timespec time;
+  time.tv_sec = _ns/1000000000ull;
+  time.tv_nsec = _ns%1000000000ull;
+  return time;
+}
+
+static uint64_t nowNs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return toNs(now);
+}
+
+int main(int argc, char* argv[])
+{
+  double duration = 10.0, periodUs = 1000.0, fallbackBudgetMs = 0.0;
+  int warmup = 100, priority = 0, cpu = -1;
+  bool lockMemory = false, closedForm = false, activeSet = false, lazySolve = false, balanceOnly = false, csv = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if (arg == "--duration" && i + 1 < argc) duration = atof(argv[++i]);
+    else if (arg == "--period" && i + 1 < argc) periodUs = atof(argv[++i]);
+    else if (arg == "--warmup" && i + 1 < argc) warmup = atoi(argv[++i]);
+    else if (arg == "--fifo" && i + 1 < argc) priority = atoi(argv[++i]);
+    else if (arg == "--cpu" && i + 1 < argc) cpu = atoi(argv[++i]);
+    else if (arg == "--mlock") lockMemory = true;
+    else if (arg == "--closed-form") closedForm = true;
+    else if (arg == "--active-set") activeSet = true;
+    else if (arg == "--lazy-solve") lazySolve = true;
+    else if (arg == "--fallback-budget" && i + 1 < argc) fallbackBudgetMs = atof(argv[++i]);
+    else if (arg == "--balance-only") balanceOnly = true;
+    else if (arg == "--csv") csv = true;
+    else {
+      std::cerr << "Unknown argument " << arg << std::endl;
+      return 1;
+    }
+  }
+
+  // Load and set up everything before going real time
+  WorldPtr world(new World);
+  world->addSkeleton(createFloor());
+  SkeletonPtr robot = createKrang();
+  if (robot == nullptr) return 1;
+  world->addSkeleton(robot);
+  world->setTimeStep(1.0/1000);
+  Controller controller(robot, robot->getBodyNode("lGripper"), robot->getBodyNode("rGripper"));
+  if (closedForm) controller.setSolver(Controller::CLOSED_FORM);
+  if (activeSet) controller.setSolver(Controller::ACTIVE_SET);
+  if (lazySolve) controller.setLazySolve(1e-4, 1e-3, 1e-4, 20);
+  if (fallbackBudgetMs > 0.0) controller.setFallback(fallbackBudgetMs*1e-3);
+  if (balanceOnly) controller.setMode(Controller::BALANCE_ONLY);
+  controller.setVerbose(false);
+
+  // A profile that cannot be applied would make the numbers meaningless
+  if (cpu >= 0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+      std::cerr << "Cannot pin to CPU " << cpu << ": " << strerror(errno) << std::endl;
+      return 1;
+    }
+  }
+  if (lockMemory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+    std::cerr << "mlockall failed: " << strerror(errno) << std::endl;
+    return 1;
+  }
+  if (priority > 0) {
+    sched_param param;
+    param.sched_priority = priority;
+    if (sched_setscheduler(0, SCHED_FIFO, &param) != 0) {
+      std::cerr << "Cannot use SCHED_FIFO " << priority << ": " << strerror(errno) << std::endl;
+      return 1;
+    }
+  }
+
+  LatencyHistogram wakeup, update, step, tick;
+  const uint64_t period = (uint64_t)(periodUs*1e3);
+  const long ticks = (long)(duration*1e9/period);
+  long missed = 0, skippedPeriods = 0;
+  Eigen::Vector3d target(0.4, 0.0, 0.8);
+  uint64_t next = nowNs() + period;
+  for (long i = 0; i < warmup + ticks; ++i) {
+    timespec wake = fromNs(next);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, nullptr) == EINTR) {}
+    const uint64_t start = nowNs();
+    controller.update(target);
+    const uint64_t updated = nowNs();
+    world->step();
+    const uint64_t end = nowNs();
+
+    if (i == warmup) {
+      wakeup.reset();
+      update.reset();
+      step.reset();
+      tick.reset();
+      missed = skippedPeriods = 0;
+    }
+    wakeup.record(start - next);
+    update.record(updated - start);
+    step.record(end - updated);
+    tick.record(end - start);
+
+    // A tick that ends after the next release misses its deadline; periods
+    // that have already gone by are skipped rather than run back to back
+    next += period;
+    if (end > next) {
+      ++missed;
+      while (next < end) {
+        next += period;
+        ++skippedPeriods;
+      }
+    }
+  }
+
+  const char* labels[4] = {"wake-up", "update", "step", "tick"};
+  const LatencyHistogram* histograms[4] = {&wakeup, &update, &step, &tick};
+  std::string profile = std::string(priority > 0 ? "fifo" + std::to_string(priority) : "other")
+    + (cpu >= 0 ? " cpu" + std::to_string(cpu) : "") + (lockMemory ? " mlock" : "")
+    + (balanceOnly ? " balance-only" : closedForm ? " closed-form" : activeSet ? " active-set" : " slsqp") + (lazySolve ? " lazy" : "")
+    + (fallbackBudgetMs > 0.0 ? " fallback" + std::to_string(fallbackBudgetMs) + "ms" : "");
+  if (csv) {
+    // profile,period_us,ticks,missed,skipped, then min,p50,p99,p99.9,max in us per row
+    std::cout << profile << "," << periodUs << "," << tick.getCount() << "," << missed << "," << skippedPeriods;
+    for (int h = 0; h < 4; ++h) {
+      std::cout << "," << histograms[h]->getMin()*1e-3 << "," << histograms[h]->getPercentile(50)*1e-3
+                << "," << histograms[h]->getPercentile(99)*1e-3 << "," << histograms[h]->getPercentile(99.9)*1e-3
+                << "," << histograms[h]->getMax()*1e-3;
+    }
+    std::cout << std::endl;
+    return 0;
+  }
+
+  std::cout << "Profile:   " << profile << std::endl;
+  std::cout << "Period:    " << periodUs << " us, " << tick.getCount() << " ticks after "
+            << warmup << " warm-up ticks" << std::endl;
+  std::cout << "Missed:    " << missed << " deadlines (" << 100.0*missed/std::max(1l, ticks)
+            << " %), " << skippedPeriods << " periods skipped" << std::endl;
+  std::cout << "[us]         min      p50      p99    p99.9      max     mean" << std::endl;
+  for (int h = 0; h < 4; ++h) {
+    std::cout.width(8);
+    std::cout << std::left << labels[h] << std::right;
+    const double values[6] = {
+      histograms[h]->getMin()*1e-3, histograms[h]->getPercentile(50)*1e-3,
+      histograms[h]->getPercentile(99)*1e-3, histograms[h]->getPercentile(99.9)*1e-3,
+      histograms[h]->getMax()*1e-3, histograms[h]->getMean()*1e-3};
+    for (int v = 0; v < 6; ++v) {
+      std::cout.width(9);
+      std::cout.precision(1);
+      std::cout << std::fixed << values[v];
+    }
+    std::cout << std::endl;
+  }
+  return 0;
+}
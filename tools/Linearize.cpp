@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Linearizes Krang with its Controller in the loop around a balanced pose:
+// the robot settles for a while from the initial pose, then every state and
+// input component is perturbed both ways on parallel worker worlds.
+//   Linearize [--settle s] [--workers n] [--kp KpxCOM] [--kv KvxCOM]
+//             [--state-step e] [--input-step e] [--closed-form]
+//             [--balance-only] [--out file]
+// The file holds A (50 x 50) and B (50 x 19) of x+ = A x + B u over one
+// 1 ms tick, x = (q, dq) and u the torques on dofs 6 to 24, and the
+// eigenvalues of A with their continuous-time equivalents log(lambda)/dt.
+// The controller's velocity filter is held fixed and is not part of x, so
+// the eigenvalues leave out its lag; both the file and the summary say so.
+
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "../Controller.hpp"
+#include "../Krang.hpp"
+#include "../Linearizer.hpp"
+
+using namespace dart::dynamics;
+using namespace dart::simulation;
+
+int main(int argc, char* argv[])
+{
+  double settle = 2.0, kp = 750.0, kv = 250.0, stateStep = 1e-6, inputStep = 1e-3;
+  std::size_t workers = std::max(1u, std::thread::hardware_concurrency());
+  bool closedForm = false, balanceOnly = false;
+  std::string out = "linearization.txt";
+  for (int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if (arg == "--settle" && i + 1 < argc) settle = atof(argv[++i]);
+    else if (arg == "--workers" && i + 1 < argc) workers = std::max(1, atoi(argv[++i]));
+    else if (arg == "--kp" && i + 1 < argc) kp = atof(argv[++i]);
+    else if (arg == "--kv" && i + 1 < argc) kv = atof(argv[++i]);
+    else if (arg == "--state-step" && i + 1 < argc) stateStep = atof(argv[++i]);
+    else if (arg == "--input-step" && i + 1 < argc) inputStep = atof(argv[++i]);
+    else if (arg == "--closed-form") closedForm = true;
+    else if (arg == "--balance-only") balanceOnly = true;
+    else if (arg == "--out" && i + 1 < argc) out = argv[++i];
+    else {
+      std::cerr << "Unknown argument " << arg << std::endl;
+      return 1;
+    }
+  }
+
+  WorldPtr world(new World);
+  world->addSkeleton(createFloor());
+  SkeletonPtr robot = createKrang();
+  if (robot == nullptr) return 1;
+  world->addSkeleton(robot);
+  world->setTimeStep(1.0/1000);
+  Controller controller(robot, robot->getBodyNode("lGripper"), robot->getBodyNode("rGripper"));
+  controller.setCOMGains(kp, kv);
+  if (closedForm) controller.setSolver(Controller::CLOSED_FORM);
+  if (balanceOnly) controller.setMode(Controller::BALANCE_ONLY);
+  controller.setVerbose(false);
+
+  const Eigen::Vector3d target(0.4, 0.0, 0.8);
+  const int settleTicks = (int)(settle/world->getTimeStep());
+  for (int i = 0; i < settleTicks; ++i) {
+    controller.update(target);
+    world->step();
+  }
+
+  typedef std::chrono::steady_clock Clock;
+  Linearizer linearizer(world, workers);
+  Clock::time_point start = Clock::now();
+  linearizer.linearize(world, controller, target, stateStep, inputStep);
+  const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  const Eigen::VectorXcd eigenvalues = linearizer.getEigenvalues();
+
+  std::ofstream file(out);
+  if (!file.is_open()) {
+    std::cerr << "Cannot write " << out << std::endl;
+    return 1;
+  }
+  const double dt = world->getTimeStep();
+  const Eigen::IOFormat rows(Eigen::FullPrecision, Eigen::DontAlignCols, " ", "\n");
+  file << "# Krang closed-loop linearization at t = " << world->getTime() << " s, dt = " << dt
+       << ", KpxCOM = " << kp << ", KvxCOM = " << kv << "\n";
+  file << "# A " << linearizer.getA().rows() << " " << linearizer.getA().cols() << "\n"
+       << linearizer.getA().format(rows) << "\n";
+  file << "# B " << linearizer.getB().rows() << " " << linearizer.getB().cols() << "\n"
+       << linearizer.getB().format(rows) << "\n";
+  file << "# note: x leaves out the velocity filter history, which is held at the snapshot;"
+          " the eigenvalues ignore the filter's lag\n";
+  file << "# eigenvalues " << eigenvalues.size() << ": re im |lambda| re(s) im(s), s = log(lambda)/dt\n";
+  file.precision(12);
+  int unstable = 0;
+  for (int i = 0; i < eigenvalues.size(); ++i) {
+    const std::complex<double> s = std::log(eigenvalues(i))/dt;
+    file << eigenvalues(i).real() << " " << eigenvalues(i).imag() << " " << std::abs(eigenvalues(i))
+         << " " << s.real() << " " << s.imag() << "\n";
+    if (std::abs(eigenvalues(i)) > 1.0 + 1e-9) ++unstable;
+  }
+
+  std::cout << "Linearized after " << settle << " s settling: " << 2*(50 + 19)
+            << " perturbed ticks on " << workers << " workers in " << elapsed*1e3 << " ms" << std::endl;
+  std::cout << "Spectral radius " << std::abs(eigenvalues(0)) << ", " << unstable
+            << " eigenvalues outside the unit circle" << std::endl;
+  std::cout << "Note: the velocity filter is held fixed, so these eigenvalues ignore its lag" << std::endl;
+  std::cout << "Wrote A, B and the eigenvalues to " << out << std::endl;
+  return 0;
+}
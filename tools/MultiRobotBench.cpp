@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Times the control loop of M Krangs sharing one world, with the controller
+// updates spread over T threads before each World::step, for M = 1, 2, 4, ...
+// up to the given count and T = 1, 2, 4, ... up to the number of cores:
+//   MultiRobotBench [--lazy] [max robots] [ticks] [scenario file]
+// With a scenario file its robots are used as given and only T varies.
+// --lazy lets the controllers reuse QP solutions while their robot is idle
+// and adds the share of reused solutions to the report.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "../Controller.hpp"
+#include "../Krang.hpp"
+#include "../Scenario.hpp"
+#include "../ThreadPool.hpp"
+
+using namespace dart::dynamics;
+using namespace dart::simulation;
+
+/// \brief Robots on a grid 2 m apart, all reaching for the default target
+std::vector<ScenarioRobot> gridScenario(std::size_t _numRobots) {
+  std::vector<ScenarioRobot> robots(_numRobots);
+  const std::size_t columns = (std::size_t)std::ceil(std::sqrt((double)_numRobots));
+  for (std::size_t i = 0; i < _numRobots; ++i) {
+    robots[i].x = 2.0*(i % columns);
+    robots[i].y = 2.0*(i / columns);
+    robots[i].heading = 0.0;
+    robots[i].eeTarget << 0.4, 0.0, 0.8;
+    robots[i].hasCOMTarget = false;
+  }
+  return robots;
+}
+
+int main(int argc, char* argv[])
+{
+  bool lazy = false;
+  int nArgs = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (std::string(argv[i]) == "--lazy") lazy = true;
+    else argv[nArgs++] = argv[i];
+  }
+  argc = nArgs;
+
+  std::size_t maxRobots = (argc > 1) ? atoi(argv[1]) : 8;
+  int ticks = (argc > 2) ? atoi(argv[2]) : 500;
+  std::vector<ScenarioRobot> scenario;
+  if (argc > 3 && !loadScenario(argv[3], &scenario)) return 1;
+  const std::size_t numCores = std::max(1u, std::thread::hardware_concurrency());
+
+  SkeletonPtr prototype = createKrang();
+
+  std::cout << "robots threads  update[ms]  step[ms]  tick[ms]  real time"
+            << (lazy ? "  reused" : "") << std::endl;
+  for (std::size_t numRobots = 1; numRobots <= maxRobots; numRobots *= 2) {
+    std::vector<ScenarioRobot> robots = scenario.empty() ? gridScenario(numRobots) : scenario;
+    for (std::size_t numThreads = 1; numThreads <= std::min(numCores, robots.size()); numThreads *= 2) {
+      WorldPtr world(new World);
+      world->addSkeleton(createFloor());
+      world->setTimeStep(1.0/1000);
+      std::vector<Controller*> controllers = addScenarioRobots(world, prototype->clone(), robots);
+      for (std::size_t i = 0; i < controllers.size(); ++i) {
+        controllers[i]->setVerbose(false);
+        if (lazy) controllers[i]->setLazySolve(1e-4, 1e-3, 1e-4, 20);
+      }
+      ThreadPool pool(numThreads);
+      std::function<void(std::size_t)> update = [&](std::size_t _i) {
+        controllers[_i]->update(robots[_i].eeTarget);
+      };
+
+      typedef std::chrono::steady_clock Clock;
+      double updateNs = 0.0, stepNs = 0.0;
+      for (int i = 0; i < ticks; ++i) {
+        Clock::time_point start = Clock::now();
+        pool.parallelFor(controllers.size(), update);
+        Clock::time_point updated = Clock::now();
+        world->step();
+        updateNs += std::chrono::duration<double, std::nano>(updated - start).count();
+        stepNs += std::chrono::duration<double, std::nano>(Clock::now() - updated).count();
+      }
+
+      const double tickMs = (updateNs + stepNs)/ticks*1e-6;
+      std::cout << robots.size() << "\t" << numThreads << "\t"
+                << updateNs/ticks*1e-6 << "\t" << stepNs/ticks*1e-6 << "\t"
+                << tickMs << "\t" << world->getTimeStep()*1e3/tickMs << "x";
+      if (lazy) {
+        std::size_t skipped = 0;
+        for (std::size_t i = 0; i < controllers.size(); ++i) skipped += controllers[i]->mNumSkippedSolves;
+        std::cout << "\t" << 100.0*skipped/(ticks*controllers.size()) << "%";
+      }
+      std::cout << std::endl;
+
+      for (std::size_t i = 0; i < controllers.size(); ++i) delete controllers[i];
+    }
+    if (!scenario.empty()) break;
+  }
+  return 0;
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Records the controller QPs of a simulated run, then solves each of them in
+// closed form in double and in float, reporting the torque error of float,
+// the constraint residual |P_*ddq_lambda - b_| of both, and the speedup.
+// The controller stacks the tasks in the solve's precision, so converting
+// the recorded P is left out of the timings:
+//   PrecisionCheck [ticks] [damping]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "../ClosedFormQP.hpp"
+#include "../Controller.hpp"
+#include "../Krang.hpp"
+
+using namespace dart::dynamics;
+using namespace dart::simulation;
+
+int main(int argc, char* argv[])
+{
+  int ticks = (argc > 1) ? atoi(argv[1]) : 2000;
+  double damping = (argc > 2) ? atof(argv[2]) : 1e-4;
+
+  WorldPtr world(new World);
+  world->addSkeleton(createFloor());
+  SkeletonPtr robot = createKrang();
+  if (robot == nullptr) return 1;
+  world->addSkeleton(robot);
+  world->setTimeStep(1.0/1000);
+  Controller controller(robot, robot->getBodyNode("lGripper"), robot->getBodyNode("rGripper"));
+  controller.setSolver(Controller::CLOSED_FORM, damping);
+  controller.setVerbose(false);
+
+  std::vector<Controller::Problem, Eigen::aligned_allocator<Controller::Problem> > problems;
+  problems.reserve(ticks);
+  Eigen::Vector3d target(0.4, 0.0, 0.8);
+  for (int i = 0; i < ticks; ++i) {
+    controller.update(target);
+    problems.push_back(controller.mProblem);
+    world->step();
+  }
+
+  typedef std::chrono::steady_clock Clock;
+  double doubleNs = 0.0, floatNs = 0.0;
+  double maxTorqueError = 0.0, sumSquaredError = 0.0, maxTorque = 0.0;
+  double maxResidual[2] = {0.0, 0.0};
+  int failures[2] = {0, 0};
+  for (std::size_t i = 0; i < problems.size(); ++i) {
+    const Controller::Problem& problem = problems[i];
+    Eigen::Matrix<double, 30, 1> x[2] = {problem.x0, problem.x0};
+    const Eigen::Matrix<double, Eigen::Dynamic, 30> P = problem.P;
+    const Eigen::Matrix<float, Eigen::Dynamic, 30> Pf = problem.P.cast<float>();
+    const Eigen::VectorXf bf = problem.b.cast<float>();
+
+    Clock::time_point start = Clock::now();
+    if (!solveClosedFormQP(P, problem.b, problem.A, problem.c, problem.x0, damping, &x[0]))
+      ++failures[0];
+    Clock::time_point middle = Clock::now();
+    if (!solveClosedFormQP(Pf, bf, problem.A, problem.c, problem.x0, damping, &x[1]))
+      ++failures[1];
+    Clock::time_point end = Clock::now();
+    doubleNs += std::chrono::duration<double, std::nano>(middle - start).count();
+    floatNs += std::chrono::duration<double, std::nano>(end - middle).count();
+
+    for (int p = 0; p < 2; ++p)
+      maxResidual[p] = std::max(maxResidual[p], (problem.A*x[p] - problem.c).cwiseAbs().maxCoeff());
+    Eigen::Matrix<double, 19, 1> torques = Controller::computeForces(problem, x[0]);
+    Eigen::Matrix<double, 19, 1> error = Controller::computeForces(problem, x[1]) - torques;
+    maxTorqueError = std::max(maxTorqueError, error.cwiseAbs().maxCoeff());
+    maxTorque = std::max(maxTorque, torques.cwiseAbs().maxCoeff());
+    sumSquaredError += error.squaredNorm()/19;
+  }
+
+  const double n = problems.size();
+  std::cout << "Recorded QPs:                  " << problems.size() << std::endl;
+  std::cout << "Failed solves (double/float):  " << failures[0] << " / " << failures[1] << std::endl;
+  std::cout << "Max |torque|:                  " << maxTorque << " Nm" << std::endl;
+  std::cout << "Float torque error max:        " << maxTorqueError << " Nm" << std::endl;
+  std::cout << "Float torque error RMS:        " << std::sqrt(sumSquaredError/n) << " Nm" << std::endl;
+  std::cout << "Max |P_*x - b_| double:        " << maxResidual[0] << std::endl;
+  std::cout << "Max |P_*x - b_| float:         " << maxResidual[1] << std::endl;
+  std::cout << "Solve time double:             " << doubleNs/n*1e-3 << " us" << std::endl;
+  std::cout << "Solve time float:              " << floatNs/n*1e-3 << " us" << std::endl;
+  std::cout << "Speedup:                       " << doubleNs/floatNs << "x" << std::endl;
+  return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Checks that a Snapshot restores a simulation exactly. The robot runs for a
+// while, the world and the controller are captured, and the run continues
+// for n ticks. The snapshot is then restored into the same world and into a
+// RolloutPool worker (a clone of the world), and the n ticks are replayed.
+// q and dq of every replayed tick must match the uninterrupted run bit for
+// bit:
+//   SnapshotCheck [--warmup ticks] [--ticks n] [--closed-form] [--active-set]
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../Controller.hpp"
+#include "../Krang.hpp"
+#include "../Snapshot.hpp"
+
+using namespace dart::dynamics;
+using namespace dart::simulation;
+
+typedef std::vector<Eigen::Matrix<double, 50, 1>,
+                    Eigen::aligned_allocator<Eigen::Matrix<double, 50, 1> > > Trace;
+
+/// \brief Run _ticks control ticks and record q and dq after each of them
+void run(const WorldPtr& _world, Controller& _controller, int _ticks, Trace* _trace) {
+  const Eigen::Vector3d target(0.4, 0.0, 0.8);
+  SkeletonPtr robot = _controller.mRobot;
+  _trace->clear();
+  for (int i = 0; i < _ticks; ++i) {
+    _controller.update(target);
+    _world->step();
+    Eigen::Matrix<double, 50, 1> state;
+    state << robot->getPositions(), robot->getVelocities();
+    _trace->push_back(state);
+  }
+}
+
+/// \brief Compare _trace with _reference bit for bit and report the result.
+/// Returns true if they are identical.
+bool report(const std::string& _label, const Trace& _reference, const Trace& _trace) {
+  int first = -1;
+  double maxDifference = 0.0;
+  for (std::size_t i = 0; i < _reference.size(); ++i) {
+    if (std::memcmp(_reference[i].data(), _trace[i].data(), sizeof(double)*50) == 0) continue;
+    if (first < 0) first = static_cast<int>(i);
+    maxDifference = std::max(maxDifference, (_reference[i] - _trace[i]).cwiseAbs().maxCoeff());
+  }
+  std::cout << _label;
+  if (first < 0) std::cout << "identical" << std::endl;
+  else std::cout << "first difference after tick " << first + 1 << ", max |difference| "
+                 << maxDifference << std::endl;
+  return first < 0;
+}
+
+int main(int argc, char* argv[])
+{
+  int warmup = 500, ticks = 1000;
+  bool closedForm = false, activeSet = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if (arg == "--warmup" && i + 1 < argc) warmup = atoi(argv[++i]);
+    else if (arg == "--ticks" && i + 1 < argc) ticks = std::max(1, atoi(argv[++i]));
+    else if (arg == "--closed-form") closedForm = true;
+    else if (arg == "--active-set") activeSet = true;
+    else {
+      std::cerr << "Unknown argument " << arg << std::endl;
+      return 1;
+    }
+  }
+
+  WorldPtr world(new World);
+  world->addSkeleton(createFloor());
+  SkeletonPtr robot = createKrang();
+  if (robot == nullptr) return 1;
+  world->addSkeleton(robot);
+  world->setTimeStep(1.0/1000);
+  Controller controller(robot, robot->getBodyNode("lGripper"), robot->getBodyNode("rGripper"));
+  if (closedForm) controller.setSolver(Controller::CLOSED_FORM);
+  if (activeSet) controller.setSolver(Controller::ACTIVE_SET);
+  controller.setVerbose(false);
+
+  const Eigen::Vector3d target(0.4, 0.0, 0.8);
+  for (int i = 0; i < warmup; ++i) {
+    controller.update(target);
+    world->step();
+  }
+
+  Snapshot snapshot;
+  snapshot.capture(world, controller);
+  RolloutPool pool(world, 1);
+
+  Trace reference, restored, cloned;
+  run(world, controller, ticks, &reference);
+
+  snapshot.restore(world, controller);
+  run(world, controller, ticks, &restored);
+
+  pool.fork(snapshot, 1, [&](std::size_t, const WorldPtr& _world, Controller& _controller) {
+    _controller.copySettings(controller);
+    run(_world, _controller, ticks, &cloned);
+  });
+
+  std::cout << "Captured after " << warmup << " ticks, replayed " << ticks << " ticks" << std::endl;
+  bool same = report("Restored into the same world: ", reference, restored);
+  same &= report("Restored into a clone:        ", reference, cloned);
+  return same ? 0 : 1;
+}
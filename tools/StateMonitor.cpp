@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Terminal monitor for the state published with --state-shm. Prints the tick
+// rate, real-time factor, last and worst tick time and the task losses:
+//   StateMonitor [name] [refresh period s]
+
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "../StateChannel.hpp"
+
+int main(int argc, char* argv[])
+{
+  std::string name = (argc > 1) ? argv[1] : "/krang_state";
+  double period = (argc > 2) ? atof(argv[2]) : 0.5;
+
+  StateReader* reader = StateReader::open(name);
+  if (reader == nullptr) {
+    fprintf(stderr, "State segment %s not found, start the simulation first\n", name.c_str());
+    return 1;
+  }
+
+  StateSnapshot previous, current;
+  while (!reader->read(&previous)) usleep(1000);
+  printf("%10s %10s %8s %10s %10s %10s %10s %10s\n",
+         "tick", "rate[Hz]", "rtf", "tick[us]", "worst[us]", "EEL", "EER", "Bal");
+  while (true) {
+    usleep(static_cast<useconds_t>(period*1e6));
+    if (!reader->read(&current)) continue;
+
+    double wall = (current.stampNs - previous.stampNs)*1e-9;
+    double rate = (wall > 0.0) ? (current.tick - previous.tick)/wall : 0.0;
+    double rtf = (wall > 0.0) ? (current.simTime - previous.simTime)/wall : 0.0;
+    printf("\r%10llu %10.1f %8.3f %10.1f %10.1f %10.3g %10.3g %10.3g",
+           static_cast<unsigned long long>(current.tick), rate, rtf,
+           current.tickNs*1e-3, current.maxTickNs*1e-3,
+           current.losses[0], current.losses[1], current.losses[2]);
+    fflush(stdout);
+    previous = current;
+  }
+
+  delete reader;
+  return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2014-2016, Humanoid Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2014-2017, Graphics Lab, Georgia Tech Research Corporation
+ * Copyright (c) 2016-2017, Personal Robotics Lab, Carnegie Mellon University
+ * All rights reserved.
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Plain C client of the KrangSim library: creates one sim, clones it into
+ * N robots and steps them all from its own loop, moving each end effector
+ * target in place through the sim's buffers, then reports steps per second:
+ *   StepClient [robots] [ticks] [ticks per call] [--closed-form] [--flat]
+ * Robots are stepped round-robin, [ticks per call] ticks at a time. */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../KrangSim.h"
+
+static double nowSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + 1e-9*now.tv_nsec;
+}
+
+int main(int argc, char* argv[])
+{
+  int numRobots = 1, ticks = 1000, batch = 1, flags = KRANG_SIM_QUIET;
+  int positional = 0, i, r;
+  for (i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--closed-form") == 0) flags |= KRANG_SIM_CLOSED_FORM;
+    else if (strcmp(argv[i], "--flat") == 0) flags |= KRANG_SIM_FLAT_FLOOR_CONTACT;
+    else if (positional < 3) {
+      int* values[] = {&numRobots, &ticks, &batch};
+      *values[positional++] = atoi(argv[i]);
+    } else {
+      fprintf(stderr, "Unknown argument %s\n", argv[i]);
+      return 1;
+    }
+  }
+  if (numRobots < 1 || ticks < 1 || batch < 1) {
+    fprintf(stderr, "robots, ticks and ticks per call must be positive\n");
+    return 1;
+  }
+
+  KrangSim** sims = (KrangSim**)calloc(numRobots, sizeof(KrangSim*));
+  const KrangSimBuffers** buffers = (const KrangSimBuffers**)calloc(numRobots, sizeof(KrangSimBuffers*));
+  sims[0] = krang_sim_create(NULL, NULL, flags);
+  if (sims[0] == NULL) {
+    fprintf(stderr, "Cannot create the sim\n");
+    return 1;
+  }
+  for (r = 1; r < numRobots; ++r) {
+    sims[r] = krang_sim_clone(sims[0]);
+    if (sims[r] == NULL) {
+      fprintf(stderr, "Cannot clone the sim\n");
+      return 1;
+    }
+  }
+  for (r = 0; r < numRobots; ++r) buffers[r] = krang_sim_buffers(sims[r]);
+
+  /* Each robot sweeps its target sideways at its own phase */
+  const double start = nowSeconds();
+  int done = 0, failed = 0;
+  while (done < ticks && !failed) {
+    const int n = (ticks - done < batch) ? ticks - done : batch;
+    for (r = 0; r < numRobots; ++r) {
+      const double t = *buffers[r]->time, phase = 0.5*t + r;
+      buffers[r]->eeTarget[1] = 0.2*sin(phase);
+      buffers[r]->eeTargetVelocity[1] = 0.1*cos(phase);
+      buffers[r]->eeTargetAcceleration[1] = -0.05*sin(phase);
+      if (krang_sim_step(sims[r], n) != n) failed = 1;
+    }
+    done += n;
+  }
+  const double elapsed = nowSeconds() - start;
+  if (failed) fprintf(stderr, "A step failed after %d ticks\n", done);
+
+  double meanNs = 0.0, maxNs = 0.0;
+  for (r = 0; r < numRobots; ++r) {
+    KrangSimTiming timing;
+    krang_sim_timing(sims[r], &timing);
+    meanNs += timing.meanTickNs/numRobots;
+    if (timing.maxTickNs > maxNs) maxNs = timing.maxTickNs;
+  }
+  printf("robots %d  ticks %d  ticks/call %d\n", numRobots, done, batch);
+  printf("steps/s %.0f total, %.0f per robot\n", (double)done*numRobots/elapsed, done/elapsed);
+  printf("tick mean %.1f us, max %.1f us\n", meanNs*1e-3, maxNs*1e-3);
+  printf("robot 0 at t = %.3f s: left gripper (%.3f %.3f %.3f)\n", *buffers[0]->time,
+         buffers[0]->eeLeft[0], buffers[0]->eeLeft[1], buffers[0]->eeLeft[2]);
+
+  for (r = 0; r < numRobots; ++r) krang_sim_destroy(sims[r]);
+  free(buffers);
+  free(sims);
+  return failed;
+}